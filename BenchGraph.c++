@@ -0,0 +1,512 @@
+// -----------------------------
+// projects/graph/BenchGraph.c++
+// -----------------------------
+
+/*
+Benchmarks Graph against the same boost::adjacency_list<setS, vecS, directedS> that
+TestGraph.c++ uses as its reference type.
+
+To compile the benchmark:
+    % g++ -O2 -DNDEBUG -pedantic -std=c++11 -Wall BenchGraph.c++ -o BenchGraph -lpthread
+
+To run the benchmark:
+    % BenchGraph                                 (10^4, 10^5 and 10^6 edges)
+    % BenchGraph 10000 1000000 100000000         (any list of edge counts)
+
+Each scale also times ConcurrentGraph inserting the uniform edges from 1, 2, 4, 8 and 16
+writer threads, so that insert scaling can be read off the add_edge_s column, fifty
+PageRank iterations written as adjacency_iterator loops against the pagerank kernels,
+triangle counting by merging setS rows against count_triangles, components found by a
+serial BFS over adjacent_vertices against connected_components, and the bytes, scan
+time and edge lookup time of EncodedGraph against CompressedGraph, before and after
+an RCM reordering.
+
+Every (graph, distribution, scale) case runs in a forked child so that peak RSS is
+measured per case. The results are printed as a JSON array on stdout.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>   // steady_clock
+#include <cmath>    // pow
+#include <cstdio>   // printf
+#include <cstdlib>  // atoll, exit
+#include <random>   // mt19937_64
+#include <string>   // string
+#include <thread>   // thread
+#include <utility>  // pair
+#include <vector>   // vector
+
+#include <sys/resource.h> // getrusage
+#include <sys/wait.h>     // waitpid
+#include <unistd.h>       // fork, pipe, read, write, sysconf
+
+#include "boost/graph/adjacency_list.hpp" // adjacency_list
+
+#include "ConcurrentGraph.h"
+#include "EncodedGraph.h"
+#include "Graph.h"
+#include "GraphAlgorithms.h"
+
+using namespace std;
+
+typedef boost::adjacency_list<boost::setS, boost::vecS, boost::directedS> boost_graph;
+
+typedef pair<int, int> edge_type;
+
+// -----------
+// bench_clock
+// -----------
+
+typedef std::chrono::steady_clock bench_clock;
+
+/**
+ * @param start the time the measured section started
+ * @return returns the seconds since start
+ */
+double seconds_since (bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();}
+
+// --------
+// rss_now
+// --------
+
+/**
+ * @return returns the resident set size of this process in bytes
+ */
+long long rss_now () {
+    long long pages = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (f != 0) {
+        long long size;
+        if (fscanf(f, "%lld %lld", &size, &pages) != 2)
+            pages = 0;
+        fclose(f);}
+    return pages * sysconf(_SC_PAGESIZE);}
+
+/**
+ * @return returns the peak resident set size of this process in bytes
+ */
+long long rss_peak () {
+    struct rusage u;
+    getrusage(RUSAGE_SELF, &u);
+    return u.ru_maxrss * 1024LL;}
+
+// ---------------
+// make_edge_list
+// ---------------
+
+/**
+ * @param distribution "uniform", "power_law" or "chain"
+ * @param m the number of edges to generate
+ * @param n returns the number of vertices
+ * @return returns m edges; uniform and power_law may contain duplicates
+ */
+vector<edge_type> make_edge_list (const string& distribution, long long m, int& n) {
+    vector<edge_type> v;
+    v.reserve(m);
+    mt19937_64 rng(378);
+    if (distribution == "chain") {
+        n = m + 1;
+        for (long long i = 0; i < m; ++i)
+            v.push_back(edge_type(i, i + 1));
+        return v;}
+    n = max<long long>(m / 8, 2);
+    uniform_real_distribution<double> u(0.0, 1.0);
+    for (long long i = 0; i < m; ++i) {
+        if (distribution == "uniform")
+            v.push_back(edge_type(rng() % n, rng() % n));
+        else // sources and targets skewed towards low ids, roughly a power law degree distribution
+            v.push_back(edge_type(n * pow(u(rng), 3.0), n * pow(u(rng), 3.0)));}
+    return v;}
+
+// ---------
+// construct
+// ---------
+
+Graph construct (const vector<edge_type>& v, int, const Graph*) {
+    return Graph(v.begin(), v.end());}
+
+boost_graph construct (const vector<edge_type>& v, int n, const boost_graph*) {
+    return boost_graph(v.begin(), v.end(), n);}
+
+// ---------
+// run_case
+// ---------
+
+/**
+ * times every operation on one graph type and returns the result as a JSON object
+ */
+template <typename G>
+string run_case (const string& name, const string& distribution, long long m) {
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef typename G::edge_iterator      edge_iterator;
+
+    int n;
+    const vector<edge_type> v = make_edge_list(distribution, m, n);
+    const long long base = rss_now();
+    volatile long long sink = 0;
+
+    bench_clock::time_point t = bench_clock::now();
+    G g;
+    for (int i = 0; i < n; ++i)
+        add_vertex(g);
+    for (long long i = 0; i < m; ++i)
+        add_edge(v[i].first, v[i].second, g);
+    const double add_edge_s = seconds_since(t);
+    const long long peak = rss_peak() - base;
+
+    t = bench_clock::now();
+    {
+    G h = construct(v, n, static_cast<const G*>(0));
+    sink += num_edges(h);
+    }
+    const double construct_s = seconds_since(t);
+
+    mt19937_64 rng(2828);
+    t = bench_clock::now();
+    for (long long i = 0; i < m; ++i) {
+        const edge_type& e = (i % 2 == 0) ? v[rng() % m] : edge_type(rng() % n, rng() % n);
+        sink += edge(e.first, e.second, g).second;}
+    const double edge_s = seconds_since(t);
+
+    t = bench_clock::now();
+    for (int u = 0; u < n; ++u) {
+        pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(u, g);
+        for (; p.first != p.second; ++p.first)
+            sink += *p.first;}
+    const double adjacent_s = seconds_since(t);
+
+    t = bench_clock::now();
+    pair<edge_iterator, edge_iterator> p = edges(g);
+    for (; p.first != p.second; ++p.first)
+        sink += target(*p.first, g);
+    const double edges_s = seconds_since(t);
+
+    const long long stored = num_edges(g);
+    char buffer[1024];
+    snprintf(buffer, sizeof(buffer),
+        "{\"graph\": \"%s\", \"distribution\": \"%s\", \"input_edges\": %lld, \"vertices\": %d, \"edges\": %lld, "
+        "\"add_edge_s\": %.6f, \"construct_s\": %.6f, \"edge_lookup_s\": %.6f, \"adjacent_vertices_s\": %.6f, "
+        "\"edges_sweep_s\": %.6f, \"peak_rss_bytes_per_edge\": %.2f}",
+        name.c_str(), distribution.c_str(), m, n, stored,
+        add_edge_s, construct_s, edge_s, adjacent_s, edges_s, stored == 0 ? 0.0 : double(peak) / stored);
+    return buffer;}
+
+// ---------------
+// run_concurrent
+// ---------------
+
+/**
+ * times threads writers adding disjoint slices of the edge list to one ConcurrentGraph
+ */
+string run_concurrent (const string& distribution, long long m, unsigned threads) {
+    int n;
+    const vector<edge_type> v = make_edge_list(distribution, m, n);
+    ConcurrentGraph g;
+    while ((int)num_vertices(g) < n) // size the vertex table up front, as the other cases do
+        add_vertex(g);
+
+    bench_clock::time_point t = bench_clock::now();
+    vector<std::thread> w;
+    for (unsigned k = 0; k < threads; ++k)
+        w.push_back(std::thread([&, k] () {
+            for (long long i = m * k / threads; i < m * (k + 1) / threads; ++i)
+                add_edge(v[i].first, v[i].second, g);}));
+    for (unsigned k = 0; k < threads; ++k)
+        w[k].join();
+    const double add_edge_s = seconds_since(t);
+
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "{\"graph\": \"ConcurrentGraph\", \"distribution\": \"%s\", \"input_edges\": %lld, \"threads\": %u, "
+        "\"edges\": %lld, \"add_edge_s\": %.6f}",
+        distribution.c_str(), m, threads, (long long)num_edges(g), add_edge_s);
+    return buffer;}
+
+// ------------
+// run_pagerank
+// ------------
+
+/**
+ * @return returns the seconds taken by PageRank iterations written as a loop over adjacent_vertices
+ */
+template <typename G>
+double iterator_pagerank (G& g, int iterations) {
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    const int n = num_vertices(g);
+    bench_clock::time_point t = bench_clock::now();
+    vector<double> r(n, 1.0 / n);
+    for (int it = 0; it < iterations; ++it) {
+        vector<double> x(n, 0.0);
+        double dangling = 0;
+        for (int u = 0; u < n; ++u) {
+            pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(u, g);
+            const long k = distance(p.first, p.second);
+            if (k == 0)
+                dangling += r[u];
+            for (; p.first != p.second; ++p.first)
+                x[*p.first] += r[u] / k;}
+        for (int w = 0; w < n; ++w)
+            x[w] = 0.15 / n + 0.85 * (x[w] + dangling / n);
+        r.swap(x);}
+    return seconds_since(t);}
+
+/**
+ * times fifty PageRank iterations as a loop over the flat rows of Graph, as a loop over
+ * setS rows, and as the pull and push pagerank kernels, which include building the transpose
+ */
+string run_pagerank (const string& distribution, long long m) {
+    int n;
+    const vector<edge_type> v = make_edge_list(distribution, m, n);
+    const int iterations = 50;
+    double set_loop_s;
+    {
+    basic_graph<int, directedS, setS> h(v.begin(), v.end());
+    set_loop_s = iterator_pagerank(h, iterations);
+    }
+    Graph g(v.begin(), v.end());
+    const double loop_s = iterator_pagerank(g, iterations);
+
+    const CompressedGraph c = freeze(g);
+    pagerank_options opt;
+    opt.tolerance      = 0;
+    opt.max_iterations = iterations;
+    opt.threads        = max(1u, std::thread::hardware_concurrency());
+    vector<double> s;
+    bench_clock::time_point t = bench_clock::now();
+    pagerank(c, s, opt);
+    const double pull_s = seconds_since(t);
+    opt.push = true;
+    t = bench_clock::now();
+    pagerank(c, s, opt);
+    const double push_s = seconds_since(t);
+
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "{\"graph\": \"pagerank\", \"distribution\": \"%s\", \"input_edges\": %lld, \"threads\": %u, "
+        "\"set_row_loop_s\": %.6f, \"flat_row_loop_s\": %.6f, \"pull_kernel_s\": %.6f, \"push_kernel_s\": %.6f}",
+        distribution.c_str(), m, opt.threads, set_loop_s, loop_s, pull_s, push_s);
+    return buffer;}
+
+// -----------
+// run_encoded
+// -----------
+
+/**
+ * @return returns the seconds taken to sum every target of g and to look up every k-th input edge
+ */
+template <typename G>
+pair<double, double> scan_and_lookup (const G& g, const vector<edge_type>& v, long long& sink) {
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    bench_clock::time_point t = bench_clock::now();
+    for (int u = 0; u != (int)num_vertices(g); ++u) {
+        pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(u, g);
+        for (; p.first != p.second; ++p.first)
+            sink += *p.first;}
+    const double scan_s = seconds_since(t);
+    t = bench_clock::now();
+    for (size_t i = 0; i < v.size(); i += 7)
+        sink += edge(v[i].first, v[i].second, g).second;
+    return make_pair(scan_s, seconds_since(t));}
+
+string run_encoded (const string& distribution, long long m) {
+    int n;
+    const vector<edge_type> v = make_edge_list(distribution, m, n);
+    long long sink = 0;
+    const std::size_t set_bytes = graph_stats(basic_graph<int, directedS, setS>(v.begin(), v.end())).total_bytes;
+    const CompressedGraph c = freeze(Graph(v.begin(), v.end()));
+    const EncodedGraph    e = encode(c);
+    const pair<double, double> tc = scan_and_lookup(c, v, sink);
+    const pair<double, double> te = scan_and_lookup(e, v, sink);
+    const EncodedGraph    r = encode(reorder(c, reorder_rcm).graph);
+
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "{\"graph\": \"encoded\", \"distribution\": \"%s\", \"input_edges\": %lld, "
+        "\"set_bytes\": %zu, \"csr_bytes\": %zu, \"encoded_bytes\": %zu, \"encoded_rcm_bytes\": %zu, "
+        "\"csr_scan_s\": %.6f, \"encoded_scan_s\": %.6f, \"csr_edge_s\": %.6f, \"encoded_edge_s\": %.6f, \"sink\": %lld}",
+        distribution.c_str(), m, set_bytes, graph_stats(c).total_bytes, graph_stats(e).total_bytes, graph_stats(r).total_bytes,
+        tc.first, te.first, tc.second, te.second, sink);
+    return buffer;}
+
+// -------------
+// run_triangles
+// -------------
+
+string run_triangles (const string& distribution, long long m) {
+    typedef basic_graph<int, undirectedS, setS> set_graph;
+    typedef set_graph::adjacency_iterator       adjacency_iterator;
+    int n;
+    const vector<edge_type> v = make_edge_list(distribution, m, n);
+    set_graph h(v.begin(), v.end());
+    bench_clock::time_point t = bench_clock::now();
+    // every triangle u < w < x once, by merging the rows of u and w past w
+    long long loop_count = 0;
+    for (int u = 0; u != (int)num_vertices(h); ++u) {
+        const pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(u, h);
+        for (adjacency_iterator w = upper_bound(p.first, p.second, u); w != p.second; ++w) {
+            const pair<adjacency_iterator, adjacency_iterator> q = adjacent_vertices(*w, h);
+            loop_count += merge_count(upper_bound(p.first, p.second, *w), p.second, upper_bound(q.first, q.second, *w), q.second);}}
+    const double set_loop_s = seconds_since(t);
+
+    const CompressedGraph c = freeze(Graph(v.begin(), v.end()));
+    t = bench_clock::now();
+    const long long one = count_triangles(c);
+    const double kernel_s = seconds_since(t);
+    const unsigned threads = max(1u, std::thread::hardware_concurrency());
+    t = bench_clock::now();
+    const long long all = count_triangles(c, threads);
+    const double parallel_s = seconds_since(t);
+
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "{\"graph\": \"triangles\", \"distribution\": \"%s\", \"input_edges\": %lld, \"threads\": %u, \"triangles\": %lld, "
+        "\"set_row_loop_s\": %.6f, \"kernel_s\": %.6f, \"parallel_kernel_s\": %.6f, \"agree\": %s}",
+        distribution.c_str(), m, threads, one, set_loop_s, kernel_s, parallel_s, (one == loop_count && one == all) ? "true" : "false");
+    return buffer;}
+
+// --------------
+// run_components
+// --------------
+
+string run_components (const string& distribution, long long m) {
+    typedef Graph::adjacency_iterator adjacency_iterator;
+    int n;
+    const vector<edge_type> v = make_edge_list(distribution, m, n);
+    Graph g(v.begin(), v.end());
+    // the serial BFS follows out edges only, so on a directed graph it over-counts components
+    bench_clock::time_point t = bench_clock::now();
+    vector<int> label(num_vertices(g), -1);
+    vector<int> queue;
+    int bfs_count = 0;
+    for (int s = 0; s != (int)num_vertices(g); ++s) {
+        if (label[s] != -1)
+            continue;
+        label[s] = bfs_count;
+        queue.assign(1, s);
+        for (size_t h = 0; h != queue.size(); ++h) {
+            const pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(queue[h], g);
+            for (adjacency_iterator i = p.first; i != p.second; ++i)
+                if (label[*i] == -1) {
+                    label[*i] = bfs_count;
+                    queue.push_back(*i);}}
+        ++bfs_count;}
+    const double bfs_s = seconds_since(t);
+
+    const CompressedGraph c = freeze(g);
+    t = bench_clock::now();
+    const size_t weak = connected_components(c, label.begin(), 1);
+    const double kernel_s = seconds_since(t);
+    const unsigned threads = max(1u, std::thread::hardware_concurrency());
+    t = bench_clock::now();
+    connected_components(c, label.begin(), threads);
+    const double parallel_s = seconds_since(t);
+    t = bench_clock::now();
+    const size_t strong = strong_components(c, label.begin());
+    const double strong_s = seconds_since(t);
+
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "{\"graph\": \"components\", \"distribution\": \"%s\", \"input_edges\": %lld, \"threads\": %u, "
+        "\"bfs_components\": %d, \"weak_components\": %zu, \"strong_components\": %zu, "
+        "\"serial_bfs_s\": %.6f, \"kernel_s\": %.6f, \"parallel_kernel_s\": %.6f, \"strong_kernel_s\": %.6f}",
+        distribution.c_str(), m, threads, bfs_count, weak, strong, bfs_s, kernel_s, parallel_s, strong_s);
+    return buffer;}
+
+// --------
+// isolated
+// --------
+
+/**
+ * runs f in a forked child and returns what it wrote, so that each case has its own peak RSS
+ */
+template <typename F>
+string isolated (F f) {
+    int fd[2];
+    if (pipe(fd) != 0)
+        exit(1);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fd[0]);
+        const string s = f();
+        if (write(fd[1], s.data(), s.size()) != (ssize_t)s.size())
+            _exit(1);
+        _exit(0);}
+    close(fd[1]);
+    string s;
+    char buffer[4096];
+    ssize_t k;
+    while ((k = read(fd[0], buffer, sizeof(buffer))) > 0)
+        s.append(buffer, k);
+    close(fd[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    return s;}
+
+// ----
+// emit
+// ----
+
+/**
+ * prints one case as the next element of the JSON array; a case whose child failed prints nothing
+ * @param r the JSON object returned by isolated, or empty
+ * @param first true until the first element is printed
+ */
+void emit (const string& r, bool& first) {
+    if (r.empty())
+        return;
+    printf("%s  %s", first ? "" : ",\n", r.c_str());
+    fflush(stdout);
+    first = false;}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    vector<long long> scales;
+    for (int i = 1; i < argc; ++i)
+        scales.push_back(atoll(argv[i]));
+    if (scales.empty()) {
+        scales.push_back(10000);
+        scales.push_back(100000);
+        scales.push_back(1000000);}
+    const char* distributions[] = {"uniform", "power_law", "chain"};
+
+    printf("[\n");
+    bool first = true;
+    for (unsigned s = 0; s < scales.size(); ++s)
+        for (unsigned d = 0; d < 3; ++d) {
+            const long long m = scales[s];
+            const string dist = distributions[d];
+            emit(isolated([&] () {return run_case<boost_graph>("boost::adjacency_list", dist, m);}), first);
+            emit(isolated([&] () {return run_case<Graph>("Graph", dist, m);}), first);}
+    for (unsigned s = 0; s < scales.size(); ++s)
+        for (unsigned threads = 1; threads <= 16; threads *= 2) {
+            const long long m = scales[s];
+            emit(isolated([&] () {return run_concurrent("uniform", m, threads);}), first);}
+    for (unsigned s = 0; s < scales.size(); ++s)
+        for (unsigned d = 0; d < 2; ++d) {
+            const long long m = scales[s];
+            const string dist = distributions[d];
+            emit(isolated([&] () {return run_pagerank(dist, m);}), first);}
+    for (unsigned s = 0; s < scales.size(); ++s)
+        for (unsigned d = 0; d < 3; ++d) {
+            const long long m = scales[s];
+            const string dist = distributions[d];
+            emit(isolated([&] () {return run_encoded(dist, m);}), first);}
+    for (unsigned s = 0; s < scales.size(); ++s)
+        for (unsigned d = 0; d < 2; ++d) {
+            const long long m = scales[s];
+            const string dist = distributions[d];
+            emit(isolated([&] () {return run_triangles(dist, m);}), first);}
+    for (unsigned s = 0; s < scales.size(); ++s)
+        for (unsigned d = 0; d < 3; ++d) {
+            const long long m = scales[s];
+            const string dist = distributions[d];
+            emit(isolated([&] () {return run_components(dist, m);}), first);}
+    printf("\n]\n");
+    return 0;}
@@ -0,0 +1,399 @@
+// --------------------------------
+// projects/graph/ConcurrentGraph.h
+// --------------------------------
+
+#ifndef ConcurrentGraph_h
+#define ConcurrentGraph_h
+
+// --------
+// includes
+// --------
+
+#include <atomic> // atomic
+#include <mutex>  // lock_guard, mutex, unique_lock
+
+#include "Graph.h"
+
+// ----------------------
+// basic_concurrent_graph
+// ----------------------
+
+/**
+ * Adjacency list graph that many threads may add vertices and edges to at once.
+ * Rows live in a segmented vertex table: segment k holds first_segment << k rows and is
+ * never moved once allocated, so growing the table does not invalidate a row that another
+ * thread is reading. Every row is guarded by one of a fixed set of striped mutexes, and each
+ * stripe keeps its own edge counter, so writers to different stripes share nothing.
+ * Rows are sorted vectors of unique targets, as with flat_setS.
+ * @param VertexId the integral type of a vertex_descriptor
+ * @param Directedness directedS, undirectedS or bidirectionalS
+ */
+template <typename VertexId = int, typename Directedness = directedS>
+class basic_concurrent_graph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef VertexId vertex_descriptor;
+        typedef pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
+
+        typedef Directedness directed_category;
+
+        typedef std::size_t vertices_size_type;
+        typedef std::size_t edges_size_type;
+
+        typedef flat_setS::row<vertex_descriptor> row_policy;
+        typedef typename row_policy::type         edge_set;
+
+        typedef typename edge_set::const_iterator adjacency_iterator;
+
+    private:
+        // ---------
+        // constants
+        // ---------
+
+        static const unsigned           first_bits    = 10;
+        static const vertices_size_type first_segment = vertices_size_type(1) << first_bits;
+        static const unsigned           max_segments  = 48;
+
+        // ----
+        // data
+        // ----
+
+        struct vertex_row {
+            edge_set out;
+            edge_set in;}; // sources, only filled for bidirectionalS
+
+        /**
+         * a lock and the number of edges whose source hashes to it; the padding keeps
+         * neighbouring stripes on different cache lines
+         */
+        struct stripe {
+            mutex                   lock;
+            atomic<edges_size_type> edges;
+            char                    pad[64];
+
+            stripe () :
+                    lock(),
+                    edges(0)
+                {}};
+
+        atomic<vertex_row*>        _segments[max_segments];
+        atomic<vertices_size_type> _n;     // published vertices; rows below _n exist
+        mutex                      _grow;  // serializes segment allocation and publication
+        stripe*                    _stripes;
+        unsigned                   _mask;  // number of stripes - 1
+
+        // ------
+        // locate
+        // ------
+
+        /**
+         * @param v a vertex id
+         * @param k returns the segment that holds v
+         * @return returns the offset of v within segment k
+         */
+        static vertices_size_type locate (vertices_size_type v, unsigned& k) {
+            const vertices_size_type i = (v >> first_bits) + 1;
+            k = 0;
+            while ((i >> (k + 1)) != 0)
+                ++k;
+            return v - ((first_segment << k) - first_segment);}
+
+        /**
+         * @return returns the row of v, which must be below _n
+         */
+        vertex_row& row (vertices_size_type v) const {
+            unsigned k;
+            const vertices_size_type o = locate(v, k);
+            return _segments[k].load(memory_order_acquire)[o];}
+
+        /**
+         * @return returns the stripe that guards the row of v
+         */
+        stripe& stripe_of (vertices_size_type v) const {
+            return _stripes[v & _mask];}
+
+        // ----
+        // grow
+        // ----
+
+        /**
+         * allocates the segments for, and then publishes, vertices up to z
+         * @param z the number of vertices the graph must have
+         * @return returns the number of vertices before the call
+         */
+        vertices_size_type grow (vertices_size_type z) {
+            lock_guard<mutex> l(_grow);
+            const vertices_size_type n = _n.load(memory_order_relaxed);
+            if (z <= n)
+                return n;
+            unsigned k;
+            locate(z - 1, k);
+            for (unsigned s = 0; s <= k; ++s)
+                if (_segments[s].load(memory_order_relaxed) == 0)
+                    _segments[s].store(new vertex_row[first_segment << s], memory_order_release);
+            _n.store(z, memory_order_release);
+            return n;}
+
+        /**
+         * @return returns the first and second stripes to lock for an edge (a, b), in address order
+         */
+        std::pair<stripe*, stripe*> stripes_of (vertex_descriptor a, vertex_descriptor b) const {
+            stripe* s = &stripe_of(a);
+            stripe* t = (Directedness::is_directed && !Directedness::has_in_edges) ? s : &stripe_of(b);
+            return (s < t) ? make_pair(s, t) : make_pair(t, s);}
+
+    public:
+        // --------
+        // add_edge
+        // --------
+
+        /**
+         * safe to call from any number of threads; grows the vertex table as add_edge on Graph does
+         * @param a vertex_descriptor to the first vertex
+         * @param b vertex_descriptor to the second vertex
+         * @param g the graph for which to add the edge
+         * @return returns a pair of an edge_descriptor and a boolean for successful or not
+         */
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor a, vertex_descriptor b, basic_concurrent_graph& g) {
+            edge_descriptor e(a, b);
+            const vertices_size_type z = (vertices_size_type)max(a, b) + 1;
+            if (z > g._n.load(memory_order_acquire))
+                g.grow(z);
+            const std::pair<stripe*, stripe*> s = g.stripes_of(a, b);
+            lock_guard<mutex>  first(s.first->lock);
+            unique_lock<mutex> second(s.second->lock, defer_lock);
+            if (s.second != s.first)
+                second.lock();
+            if (!row_policy::insert(g.row(a).out, b))
+                return make_pair(e, false);
+            if (!Directedness::is_directed && a != b)
+                row_policy::insert(g.row(b).out, a);
+            if (Directedness::has_in_edges)
+                row_policy::insert(g.row(b).in, a);
+            g.stripe_of(a).edges.fetch_add(1, memory_order_relaxed);
+            return make_pair(e, true);}
+
+        // ----------
+        // add_vertex
+        // ----------
+
+        /**
+         * safe to call from any number of threads; each call returns a different vertex
+         * @param g graph for which to add the vertex
+         * @return returns the vertex_descriptor for the new vertex
+         */
+        friend vertex_descriptor add_vertex (basic_concurrent_graph& g) {
+            lock_guard<mutex> l(g._grow);
+            const vertices_size_type n = g._n.load(memory_order_relaxed);
+            unsigned k;
+            locate(n, k);
+            if (g._segments[k].load(memory_order_relaxed) == 0)
+                g._segments[k].store(new vertex_row[first_segment << k], memory_order_release);
+            g._n.store(n + 1, memory_order_release);
+            return n;}
+
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * the iterators read the row without its lock, so they are only valid while no thread
+         * adds an edge out of v; use for_each_adjacent while writers are running
+         * @param v vertex_descriptor for which you want the adjacent vertices of
+         * @param g the graph for which to get the adjacent vertices from
+         * @return returns a pair of adjacency iterators for the beginning and end
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const basic_concurrent_graph& g) {
+            const edge_set& r = g.row(v).out;
+            return std::make_pair(r.begin(), r.end());}
+
+        // -----------------
+        // for_each_adjacent
+        // -----------------
+
+        /**
+         * calls f(vertex_descriptor) on every target of v while holding the lock of v's row
+         * @param v the source vertex
+         * @param g the graph
+         * @param f callable taking a vertex_descriptor; it must not add edges to g
+         */
+        template <typename F>
+        friend void for_each_adjacent (vertex_descriptor v, const basic_concurrent_graph& g, F f) {
+            lock_guard<mutex> l(g.stripe_of(v).lock);
+            const edge_set& r = g.row(v).out;
+            for (adjacency_iterator i = r.begin(); i != r.end(); ++i)
+                f(*i);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * safe to call while other threads add edges
+         * @param a vertex_descriptor of the main vertex
+         * @param b vertex_descriptor of the secondary vertex
+         * @param g graph for which to get the edge from
+         * @return returns a pair of an edge_descriptor and a boolean
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor a, vertex_descriptor b, const basic_concurrent_graph& g) {
+            edge_descriptor e(a, b);
+            const vertices_size_type n = num_vertices(g);
+            if ((vertices_size_type)a >= n || (vertices_size_type)b >= n)
+                return make_pair(e, false);
+            lock_guard<mutex> l(g.stripe_of(a).lock);
+            return make_pair(e, row_policy::count(g.row(a).out, b) != 0);}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * safe to call while other threads add edges
+         * @param v vertex_descriptor of the source vertex
+         * @param g the graph
+         * @return returns the number of edges out of v
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const basic_concurrent_graph& g) {
+            lock_guard<mutex> l(g.stripe_of(v).lock);
+            return g.row(v).out.size();}
+
+        // ---------
+        // in_degree
+        // ---------
+
+        /**
+         * safe to call while other threads add edges
+         * @param v vertex_descriptor of the target vertex
+         * @param g a bidirectionalS graph
+         * @return returns the number of edges into v
+         */
+        friend edges_size_type in_degree (vertex_descriptor v, const basic_concurrent_graph& g) {
+            static_assert(Directedness::has_in_edges, "in_degree requires bidirectionalS");
+            lock_guard<mutex> l(g.stripe_of(v).lock);
+            return g.row(v).in.size();}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * sums the stripe counters; exact once the writers have stopped
+         * @param g the graph
+         * @return returns the number of edges in the graph
+         */
+        friend edges_size_type num_edges (const basic_concurrent_graph& g) {
+            edges_size_type m = 0;
+            for (unsigned s = 0; s <= g._mask; ++s)
+                m += g._stripes[s].edges.load(memory_order_relaxed);
+            return m;}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g the graph
+         * @return returns the number of vertices whose rows are published
+         */
+        friend vertices_size_type num_vertices (const basic_concurrent_graph& g) {
+            return g._n.load(memory_order_acquire);}
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param e edge_descriptor of the edge
+         * @param g graph the edge belongs to
+         * @return returns the source vertex of the edge
+         */
+        friend vertex_descriptor source (edge_descriptor e, const basic_concurrent_graph&) {
+            return e.first;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param e edge_descriptor of the edge
+         * @param g graph the edge belongs to
+         * @return returns the target vertex of the edge
+         */
+        friend vertex_descriptor target (edge_descriptor e, const basic_concurrent_graph&) {
+            return e.second;}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * @param i the index of the vertex
+         * @param g the graph
+         * @return returns the vertex_descriptor of the i-th vertex
+         */
+        friend vertex_descriptor vertex (vertices_size_type i, const basic_concurrent_graph&) {
+            return i;}
+
+        // ------
+        // freeze
+        // ------
+
+        /**
+         * packs every row into a compressed snapshot; call it once the writers have stopped
+         * @param g the graph to take an immutable snapshot of
+         * @return returns a basic_compressed_graph with the same vertices and edges as g
+         */
+        friend basic_compressed_graph<vertex_descriptor> freeze (const basic_concurrent_graph& g) {
+            struct arrays {
+                vector<edges_size_type>   offsets;
+                vector<vertex_descriptor> targets;};
+            const vertices_size_type n = num_vertices(g);
+            shared_ptr<arrays> a = make_shared<arrays>();
+            a->offsets.reserve(n + 1);
+            a->offsets.push_back(0);
+            for (vertices_size_type v = 0; v != n; ++v) {
+                const edge_set& r = g.row(v).out;
+                a->targets.insert(a->targets.end(), r.begin(), r.end());
+                a->offsets.push_back(a->targets.size());}
+            return basic_compressed_graph<vertex_descriptor>(a, a->offsets.data(), a->targets.data(), n);}
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param stripes the number of row locks, rounded up to a power of two; more stripes
+         *        mean fewer collisions between writers
+         */
+        explicit basic_concurrent_graph (unsigned stripes = 1024) :
+                _n(0),
+                _grow(),
+                _stripes(),
+                _mask() {
+            unsigned k = 1;
+            while (k < stripes)
+                k <<= 1;
+            _stripes = new stripe[k];
+            _mask    = k - 1;
+            for (unsigned s = 0; s != max_segments; ++s)
+                _segments[s].store(0, memory_order_relaxed);}
+
+        ~basic_concurrent_graph () {
+            for (unsigned s = 0; s != max_segments; ++s)
+                delete [] _segments[s].load(memory_order_relaxed);
+            delete [] _stripes;}
+
+        // the locks and the segments are not copyable
+        basic_concurrent_graph (const basic_concurrent_graph&) = delete;
+        basic_concurrent_graph& operator = (const basic_concurrent_graph&) = delete;
+    };
+
+/**
+ * the concurrent counterpart of Graph
+ */
+typedef basic_concurrent_graph<> ConcurrentGraph;
+
+#endif // ConcurrentGraph_h
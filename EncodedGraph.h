@@ -0,0 +1,613 @@
+// -----------------------------
+// projects/graph/EncodedGraph.h
+// -----------------------------
+
+#ifndef EncodedGraph_h
+#define EncodedGraph_h
+
+// --------
+// includes
+// --------
+
+#include <stdexcept> // length_error
+#include <stdint.h>  // int64_t, uint32_t, uint64_t
+
+#include "Graph.h"
+
+// An encoded graph keeps each sorted row as a run of LEB128 varints: the first target as
+// a zigzag-coded offset from its source vertex, every later target as the gap to the one
+// before it. A row longer than one block of targets is prefixed with a skip
+// table holding the first target and the byte position of every later block, so edge()
+// decodes at most one block after walking the table. Row positions are stored in two
+// levels, a 64-bit base for every 64 vertices and a 32-bit offset from it per vertex.
+// The iterators decode on the fly; nothing is expanded up front.
+
+// ------
+// varint
+// ------
+
+/**
+ * appends x to out as a LEB128 varint, seven bits per byte, low bits first
+ */
+inline void varint_put (uint64_t x, vector<unsigned char>& out) {
+    while (x >= 0x80) {
+        out.push_back((unsigned char)(x | 0x80));
+        x >>= 7;}
+    out.push_back((unsigned char)x);}
+
+/**
+ * @param p points at a varint written by varint_put; moved past it
+ * @return returns the value of the varint
+ */
+inline uint64_t varint_get (const unsigned char*& p) {
+    uint64_t x = *p++;
+    if (x < 0x80)
+        return x;
+    x &= 0x7f;
+    for (unsigned s = 7; ; s += 7) {
+        const uint64_t b = *p++;
+        x |= (b & 0x7f) << s;
+        if (b < 0x80)
+            return x;}}
+
+/**
+ * @return returns d mapped onto the naturals so that small magnitudes stay small: 0, -1, 1, -2, ...
+ */
+inline uint64_t zigzag (int64_t d) {
+    return ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);}
+
+/**
+ * @return returns the inverse of zigzag
+ */
+inline int64_t unzigzag (uint64_t x) {
+    return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);}
+
+// -------------------
+// basic_encoded_graph
+// -------------------
+
+/**
+ * Immutable, delta and varint encoded snapshot of a graph, read through the same free
+ * functions as basic_compressed_graph. Copies share the encoded arrays. As with the other
+ * snapshots, an encoded undirected graph holds both directions of every edge.
+ */
+template <typename VertexId = int>
+class basic_encoded_graph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef VertexId vertex_descriptor;
+        typedef pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
+
+        typedef std::size_t vertices_size_type;
+        typedef std::size_t edges_size_type;
+
+        typedef typename basic_compressed_graph<VertexId>::vertex_iterator vertex_iterator;
+
+        /**
+         * the number of targets between two skip table entries
+         */
+        static const edges_size_type block = 64;
+
+        // ------------
+        // adjacency_iterator class
+        // ------------
+        class adjacency_iterator : public iterator<forward_iterator_tag, vertex_descriptor>
+        {
+            public:
+                /**
+                 * Checks if two adjacency_iterators are equal.
+                 * @param rhs first adjacency_iterator
+                 * @param lhs second adjacency_iterator
+                 * @return true if equal, false if not
+                 */
+                friend bool operator == (const adjacency_iterator& rhs, const adjacency_iterator& lhs) {
+                    return (rhs._p == lhs._p) && (rhs._left == lhs._left);
+                }
+            private:
+                const unsigned char* _p;    // the next varint to decode
+                edges_size_type      _left; // targets left in the row, counting the current one
+                vertex_descriptor    _v;    // the current target
+            public:
+                /**
+                 * Constructor for adjacency_iterator
+                 * @param p the varint after the current target; the end of the row for an end iterator
+                 * @param left the number of targets left, counting v; 0 for an end iterator
+                 * @param v the current target
+                 */
+                adjacency_iterator(const unsigned char* p = 0, edges_size_type left = 0, vertex_descriptor v = vertex_descriptor()) :
+                    _p(p),
+                    _left(left),
+                    _v(v)
+                    {}
+                /**
+                 * Dereferences adjacency_iterator
+                 * @return const reference to the current target
+                 */
+                const vertex_descriptor& operator * () const {
+                    return _v;
+                }
+                /**
+                 * Pre-increment on iterator; decodes the next gap.
+                 * @return reference to self (*this)
+                 */
+                adjacency_iterator& operator ++ () {
+                    if (--_left != 0)
+                        _v = vertex_descriptor(_v + varint_get(_p));
+                    return *this;
+                }
+                /**
+                 * Post-increment on iterator.
+                 * @return copy of this iterator before increment
+                 */
+                adjacency_iterator operator ++ (int) {
+                    adjacency_iterator temp = *this;
+                    ++*this;
+                    return temp;
+                }
+        };
+
+    private:
+        // ----
+        // data
+        // ----
+
+        /**
+         * the encoded rows and where each one starts
+         */
+        struct arrays {
+            vector<edges_size_type> bases; // the byte position of every 64th row
+            vector<uint32_t>        rows;  // num_vertices + 1 row starts, relative to their base
+            vector<unsigned char>   bytes;};
+
+        shared_ptr<const arrays> _a;
+        vertices_size_type       _n;
+        edges_size_type          _m;
+
+        /**
+         * @return returns the byte position of row v, for v up to num_vertices
+         */
+        edges_size_type start (vertices_size_type v) const {
+            return _a->bases[v >> 6] + _a->rows[v];}
+
+        /**
+         * @param p the first byte of a non-empty row; moved past its header to the first target
+         * @param skips set to the skip table, or to 0 if the row has a single block
+         * @return returns the degree of the row
+         */
+        static edges_size_type header (const unsigned char*& p, const unsigned char*& skips) {
+            const edges_size_type d = varint_get(p);
+            skips = 0;
+            if (d > block) {
+                const edges_size_type k = varint_get(p);
+                skips = p;
+                p += k;}
+            return d;}
+
+        /**
+         * @param v a vertex below _n
+         * @return returns a pair of adjacency iterators over the row of v
+         */
+        std::pair<adjacency_iterator, adjacency_iterator> row_of (vertices_size_type v) const {
+            const unsigned char* p = _a->bytes.data() + start(v);
+            const unsigned char* e = _a->bytes.data() + start(v + 1);
+            if (p == e)
+                return std::make_pair(adjacency_iterator(e), adjacency_iterator(e));
+            const unsigned char* skips;
+            const edges_size_type d = header(p, skips);
+            const vertex_descriptor t = vertex_descriptor((int64_t)v + unzigzag(varint_get(p)));
+            return std::make_pair(adjacency_iterator(p, d, t), adjacency_iterator(e));}
+
+        /**
+         * appends the header and the targets of one row to out
+         * @param u the source of the row
+         * @param b iterator to the first of d sorted targets
+         * @param data scratch space for the gaps
+         * @param skips scratch space for the skip table
+         */
+        template <typename II>
+        static void encode_row (vertex_descriptor u, II b, edges_size_type d, vector<unsigned char>& out, vector<unsigned char>& data, vector<unsigned char>& skips) {
+            if (d == 0)
+                return;
+            data.clear();
+            skips.clear();
+            vertex_descriptor first = *b;
+            vertex_descriptor prev  = *b;
+            edges_size_type   at    = 0;
+            varint_put(zigzag((int64_t)prev - (int64_t)u), data);
+            for (edges_size_type i = 1; i != d; ++i) {
+                const vertex_descriptor t = *++b;
+                if (i % block == 0) {
+                    varint_put(t - first, skips);
+                    varint_put(data.size() - at, skips);
+                    first = t;
+                    at    = data.size();}
+                varint_put(t - prev, data);
+                prev = t;}
+            varint_put(d, out);
+            if (d > block) {
+                varint_put(skips.size(), out);
+                out.insert(out.end(), skips.begin(), skips.end());}
+            out.insert(out.end(), data.begin(), data.end());}
+
+        /**
+         * records that row v starts at byte p; rows are placed in increasing order
+         */
+        static void place (arrays& a, vertices_size_type v, edges_size_type p) {
+            if ((v & 63) == 0)
+                a.bases[v >> 6] = p;
+            if (p - a.bases[v >> 6] > 0xffffffffu)
+                throw length_error("basic_encoded_graph: 64 rows span more than 4 GiB");
+            a.rows[v] = (uint32_t)(p - a.bases[v >> 6]);}
+
+        // -----
+        // valid
+        // -----
+
+        /**
+         * @return returns a boolean stating whether the row starts cover the encoded bytes
+         */
+        bool valid () const {
+            return (_a->rows.size() == _n + 1) && (start(0) == 0) && (start(_n) == _a->bytes.size());}
+
+    public:
+        // ------------
+        // edge_iterator class
+        // ------------
+        class edge_iterator : public iterator<forward_iterator_tag, edge_descriptor>
+        {
+            public:
+                /**
+                 * Checks if two edge_iterators are equal.
+                 * @param rhs first edge_iterator
+                 * @param lhs second edge_iterator
+                 * @return true if equal, false if not
+                 */
+                friend bool operator == (const edge_iterator& rhs, const edge_iterator& lhs) {
+                    return (rhs._g == lhs._g) && (rhs._u == lhs._u) && (rhs._p == lhs._p);
+                }
+            private:
+                /**
+                 * moves to the next non-empty row while the current one is used up
+                 */
+                void settle() {
+                    while (_p == _e && _u != _g->_n) {
+                        if (++_u == _g->_n) {
+                            _p = _e = adjacency_iterator();
+                            break;}
+                        std::pair<adjacency_iterator, adjacency_iterator> r = _g->row_of(_u);
+                        _p = r.first;
+                        _e = r.second;
+                    }
+                }
+
+                const basic_encoded_graph* _g;
+                vertices_size_type _u;
+                adjacency_iterator _p;
+                adjacency_iterator _e;
+            public:
+                /**
+                 * Constructor for edge_iterator
+                 * @param g pointer to the graph being iterated on.
+                 * @param u the first row to visit; num_vertices for the end.
+                 */
+                edge_iterator(const basic_encoded_graph* g, vertices_size_type u) :
+                    _g(g),
+                    _u(u),
+                    _p(),
+                    _e() {
+                    if (_u != _g->_n) {
+                        std::pair<adjacency_iterator, adjacency_iterator> r = _g->row_of(_u);
+                        _p = r.first;
+                        _e = r.second;
+                        settle();}
+                    }
+                /**
+                 * Dereferences edge_iterator
+                 * @return the edge_descriptor at the current position
+                 */
+                edge_descriptor operator * () const {
+                    return edge_descriptor(_u, *_p);
+                }
+                /**
+                 * Pre-increment on edge iterator.
+                 * @return reference to self (*this)
+                 */
+                edge_iterator& operator ++ () {
+                    ++_p;
+                    settle();
+                    return *this;
+                }
+                /**
+                 * Post-increment on edge iterator.
+                 * @return copy of this iterator before increment
+                 */
+                edge_iterator operator ++ (int) {
+                    edge_iterator temp = *this;
+                    ++*this;
+                    return temp;
+                }
+        };
+
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param v vertex_descriptor for which you want the adjacent vertices of
+         * @param g the graph for which to get the adjacent vertices from
+         * @return returns a pair of adjacency iterators that decode the row of v as they advance
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const basic_encoded_graph& g) {
+            return g.row_of(v);}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v vertex_descriptor of the source vertex
+         * @param g the graph
+         * @return returns the number of edges out of v, read from the row header
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const basic_encoded_graph& g) {
+            const unsigned char* p = g._a->bytes.data() + g.start(v);
+            if (p == g._a->bytes.data() + g.start(v + 1))
+                return 0;
+            return varint_get(p);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * @param a vertex_descriptor of the main vertex
+         * @param b vertex_descriptor of the secondary vertex
+         * @param g graph for which to get the edge from
+         * @return returns a pair of an edge_descriptor and a boolean, found by walking the skip table of a and decoding one block
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor a, vertex_descriptor b, const basic_encoded_graph& g) {
+            edge_descriptor e(a, b);
+            if ((vertices_size_type)a >= num_vertices(g) || (vertices_size_type)b >= num_vertices(g))
+                return make_pair(e, false);
+            const unsigned char* p = g._a->bytes.data() + g.start(a);
+            if (p == g._a->bytes.data() + g.start(a + 1))
+                return make_pair(e, false);
+            const unsigned char* skips;
+            edges_size_type left = header(p, skips);
+            const unsigned char* data = p;
+            vertex_descriptor t = vertex_descriptor((int64_t)a + unzigzag(varint_get(p)));
+            if (skips != 0 && t < b) {
+                vertex_descriptor first = t;
+                edges_size_type   at    = 0;
+                edges_size_type   k     = 0;
+                while (skips != data) {
+                    const vertex_descriptor f = vertex_descriptor(first + varint_get(skips));
+                    const edges_size_type   d = varint_get(skips);
+                    if (b < f)
+                        break;
+                    first = f;
+                    at   += d;
+                    ++k;}
+                if (k != 0) {
+                    p = data + at;
+                    varint_get(p);
+                    t     = first;
+                    left -= k * block;}}
+            while (t < b && --left != 0)
+                t = vertex_descriptor(t + varint_get(p));
+            return make_pair(e, t == b);}
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * @param g the graph for which to get the iterator over edges from
+         * @return returns a pair of edge_iterators for the beginning and the end
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const basic_encoded_graph& g) {
+            return std::make_pair(edge_iterator(&g, 0), edge_iterator(&g, g._n));}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param g the graph for which to get the number of edges from
+         * @return returns the number of edges in the graph
+         */
+        friend edges_size_type num_edges (const basic_encoded_graph& g) {
+            return g._m;}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g the graph for which to get the number of vertices from
+         * @return returns the number of vertices in the graph
+         */
+        friend vertices_size_type num_vertices (const basic_encoded_graph& g) {
+            return g._n;}
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param e edge_descriptor from which to get the source
+         * @param g the graph for which to get the source from
+         * @return returns the main vertex in an edge
+         */
+        friend vertex_descriptor source (edge_descriptor e, const basic_encoded_graph&) {
+            return e.first;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param e edge_descriptor from which to get the target
+         * @param g the graph for which to get the target from
+         * @return returns the secondary vertex in an edge
+         */
+        friend vertex_descriptor target (edge_descriptor e, const basic_encoded_graph&) {
+            return e.second;}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * @param i index of the vertex
+         * @param g graph from which to get the vertex_descriptor from
+         * @return returns the vertex_descriptor at index i
+         */
+        friend vertex_descriptor vertex (vertices_size_type i, const basic_encoded_graph&) {
+            return i;}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param g graph from which to get the vertex iterators from
+         * @return returns a pair of vertex iterators which are the beginning and the end of the graph's vertices
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const basic_encoded_graph& g) {
+            return make_pair(vertex_iterator(0), vertex_iterator(num_vertices(g)));}
+
+        // ------
+        // freeze
+        // ------
+
+        /**
+         * @param g the graph to decode
+         * @return returns a basic_compressed_graph with the same vertices and edges as g
+         */
+        friend basic_compressed_graph<vertex_descriptor> freeze (const basic_encoded_graph& g) {
+            struct arrays {
+                vector<edges_size_type>   offsets;
+                vector<vertex_descriptor> targets;};
+            shared_ptr<arrays> a = make_shared<arrays>();
+            a->offsets.reserve(g._n + 1);
+            a->targets.reserve(g._m);
+            a->offsets.push_back(0);
+            for (vertices_size_type v = 0; v != g._n; ++v) {
+                std::pair<adjacency_iterator, adjacency_iterator> p = g.row_of(v);
+                a->targets.insert(a->targets.end(), p.first, p.second);
+                a->offsets.push_back(a->targets.size());}
+            return basic_compressed_graph<vertex_descriptor>(a, a->offsets.data(), a->targets.data(), g._n);}
+
+        // -----------
+        // graph_stats
+        // -----------
+
+        /**
+         * @param g the graph to measure; its arrays have no slack, so the load factor is 1
+         * @return returns the memory used by g, broken down by component, and its out degree distribution
+         */
+        friend graph_statistics graph_stats (const basic_encoded_graph& g) {
+            graph_statistics s;
+            vector<std::size_t> d;
+            d.reserve(g._n);
+            for (vertices_size_type v = 0; v != g._n; ++v)
+                d.push_back(out_degree(v, g));
+            summarize_degrees(d, s);
+            s.edges              = g._m;
+            s.vertex_table_bytes = g._a->bases.size() * sizeof(edges_size_type) + g._a->rows.size() * sizeof(uint32_t);
+            s.row_bytes          = g._a->bytes.size();
+            s.total_bytes        = sizeof(g) + s.vertex_table_bytes + s.row_bytes;
+            return s;}
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * builds an empty graph
+         */
+        basic_encoded_graph () : _a(), _n(), _m() {
+            shared_ptr<arrays> a = make_shared<arrays>();
+            a->bases.push_back(0);
+            a->rows.push_back(0);
+            _a = a;
+            assert(valid());}
+
+        /**
+         * encodes every row of g; each thread encodes a contiguous range of rows into its own
+         * buffer, and the buffers are joined in order
+         * @param g a CompressedGraph or GraphSnapshot, or any other snapshot whose rows are sorted
+         * @param threads the number of threads encoding rows
+         */
+        template <typename G>
+        explicit basic_encoded_graph (const G& g, unsigned threads = 1) : _a(), _n(num_vertices(g)), _m() {
+            typedef typename G::adjacency_iterator adjacency_iterator;
+            const unsigned                k = max(threads, 1u);
+            vector< vector<unsigned char> > bytes(k);
+            vector< vector<edges_size_type> > local(k);
+            vector<edges_size_type>         degrees(k, 0);
+            vector<vertices_size_type>      begin(k + 1, _n);
+            parallel_for(_n, k, [&] (std::size_t b, std::size_t e, unsigned t) {
+                vector<unsigned char> data;
+                vector<unsigned char> skips;
+                begin[t] = b;
+                local[t].reserve(e - b);
+                for (std::size_t v = b; v != e; ++v) {
+                    local[t].push_back(bytes[t].size());
+                    const std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, g);
+                    const edges_size_type d = out_degree(v, g);
+                    encode_row(v, p.first, d, bytes[t], data, skips);
+                    degrees[t] += d;}});
+            shared_ptr<arrays> a = make_shared<arrays>();
+            a->bases.resize((_n >> 6) + 1);
+            a->rows.resize(_n + 1);
+            edges_size_type at = 0;
+            for (unsigned t = 0; t != k; ++t) {
+                for (std::size_t i = 0; i != local[t].size(); ++i)
+                    place(*a, begin[t] + i, at + local[t][i]);
+                at += bytes[t].size();
+                _m += degrees[t];}
+            place(*a, _n, at);
+            a->bytes.reserve(at);
+            for (unsigned t = 0; t != k; ++t) {
+                a->bytes.insert(a->bytes.end(), bytes[t].begin(), bytes[t].end());
+                vector<unsigned char>().swap(bytes[t]);}
+            _a = a;
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment
+    };
+
+/**
+ * the encoded snapshot type of Graph
+ */
+typedef basic_encoded_graph<> EncodedGraph;
+
+// ------
+// encode
+// ------
+
+/**
+ * @param g the snapshot to encode, with sorted rows
+ * @param threads the number of threads encoding rows
+ * @return returns a basic_encoded_graph with the same vertices and edges as g
+ */
+template <typename G>
+basic_encoded_graph<typename G::vertex_descriptor> encode (const G& g, unsigned threads = 1) {
+    return basic_encoded_graph<typename G::vertex_descriptor>(g, threads);}
+
+/**
+ * encodes a Graph by way of freeze, so its CSR snapshot is held until the encoding is done
+ * @param g the graph to encode
+ * @param threads the number of threads encoding rows
+ * @return returns a basic_encoded_graph with the same vertices and edges as g
+ */
+template <typename V, typename D, typename C>
+basic_encoded_graph<V> encode (const basic_graph<V, D, C>& g, unsigned threads = 1) {
+    return basic_encoded_graph<V>(freeze(g), threads);}
+
+#endif // EncodedGraph_h
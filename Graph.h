@@ -21,6 +21,13 @@
 #include <iterator>
 #include <set>
 #include <iostream> // cout, endl
+#include <numeric>  // accumulate, partial_sum
+#include <thread>   // thread
+#include <memory>   // make_shared, shared_ptr
+#include <atomic>   // atomic
+#include <stdexcept> // invalid_argument
+
+#include "GraphMetrics.h" // GRAPH_PROBE, GRAPH_COUNT
 
 using namespace std;
 using std::rel_ops::operator!=;
@@ -30,25 +37,362 @@ using std::rel_ops::operator>=;
 
 ostream& operator << (ostream& lhs, const pair<int, int>& rhs){
     return lhs << "(" << rhs.first << "," << rhs.second << ")"; }
-    
 
-// -----
-// Graph
-// -----
+// ------------
+// parallel_for
+// ------------
+
+/**
+ * splits [0, n) into contiguous chunks and runs f(begin, end, chunk) on each chunk in its own thread
+ * @param n the size of the index range
+ * @param threads the number of chunks; 0 and 1 both run f on the calling thread
+ * @param f callable taking (std::size_t begin, std::size_t end, unsigned chunk)
+ */
+template <typename F>
+void parallel_for (std::size_t n, unsigned threads, F f) {
+    if (threads <= 1 || n < 2) {
+        f(std::size_t(0), n, 0u);
+        return;}
+    vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned t = 0; t < threads; ++t)
+        workers.push_back(std::thread(f, n * t / threads, n * (t + 1) / threads, t));
+    for (unsigned t = 0; t < threads; ++t)
+        workers[t].join();}
+
+// -----------
+// dynamic_for
+// -----------
+
+/**
+ * runs f(begin, end, thread) on chunks of grain indices of [0, n) that the threads take from
+ * a shared counter as they finish, so that skewed work evens out across the threads
+ * @param n the size of the index range
+ * @param threads the number of threads; 0 and 1 both run f on the calling thread
+ * @param grain the number of indices taken at a time
+ * @param f callable taking (std::size_t begin, std::size_t end, unsigned thread), called any number of times per thread
+ */
+template <typename F>
+void dynamic_for (std::size_t n, unsigned threads, std::size_t grain, F f) {
+    grain = max<std::size_t>(grain, 1);
+    if (threads <= 1 || n <= grain) {
+        f(std::size_t(0), n, 0u);
+        return;}
+    std::atomic<std::size_t> next(0);
+    parallel_for(threads, threads, [&] (std::size_t t, std::size_t, unsigned) {
+        for (std::size_t b = next.fetch_add(grain); b < n; b = next.fetch_add(grain))
+            f(b, min(n, b + grain), unsigned(t));});}
+
+
+// ----------------------
+// directedness selectors
+// ----------------------
+
+/**
+ * every edge is stored once, in the row of its source
+ */
+struct directedS {
+    static const bool is_directed  = true;
+    static const bool has_in_edges = false;};
+
+/**
+ * every edge is stored in the rows of both endpoints, but counted and listed once
+ */
+struct undirectedS {
+    static const bool is_directed  = false;
+    static const bool has_in_edges = false;};
+
+/**
+ * directed, plus a reverse row of sources per vertex kept in sync by add_edge and add_edges
+ */
+struct bidirectionalS {
+    static const bool is_directed  = true;
+    static const bool has_in_edges = true;};
+
+// -------------------
+// container selectors
+// -------------------
+
+// A row holds the targets of one vertex; the source is the row index, so it is not stored.
+// Each selector provides row<V>::type and the operations basic_graph needs on it:
+// insert, count, erase, merge and subtract of a sorted range, drop, which removes
+// a vertex and renumbers the targets above it, and capacity and bytes for graph_stats.
+
+/**
+ * sorted, unique targets in contiguous memory (the default)
+ */
+struct flat_setS {
+    template <typename V>
+    struct row {
+        typedef vector<V> type;
+
+        static bool insert (type& r, V v) {
+            typename type::iterator p = lower_bound(r.begin(), r.end(), v);
+            if (p != r.end() && *p == v)
+                return false;
+            r.insert(p, v);
+            return true;}
+
+        static std::size_t count (const type& r, V v) {
+            return binary_search(r.begin(), r.end(), v) ? 1 : 0;}
 
-class Graph {
+        static std::size_t erase (type& r, V v) {
+            const std::pair<typename type::iterator, typename type::iterator> p = equal_range(r.begin(), r.end(), v);
+            const std::size_t k = p.second - p.first;
+            r.erase(p.first, p.second);
+            return k;}
+
+        template <typename RI>
+        static std::size_t merge (type& r, RI b, RI e) {
+            e = unique(b, e);
+            const std::size_t old = r.size();
+            if (r.empty())
+                r.assign(b, e);
+            else {
+                type u;
+                u.reserve(old + (e - b));
+                set_union(r.begin(), r.end(), b, e, back_inserter(u));
+                r.swap(u);}
+            return r.size() - old;}
+
+        template <typename RI>
+        static std::size_t subtract (type& r, RI b, RI e) {
+            const std::size_t old = r.size();
+            typename type::iterator w = r.begin();
+            for (typename type::iterator i = r.begin(); i != r.end(); ++i) {
+                while (b != e && *b < *i)
+                    ++b;
+                if (b == e || *i < *b)
+                    *w++ = *i;}
+            r.erase(w, r.end());
+            return old - r.size();}
+
+        static std::size_t drop (type& r, V v) {
+            const std::size_t k = erase(r, v);
+            for (typename type::iterator i = upper_bound(r.begin(), r.end(), v); i != r.end(); ++i)
+                --*i;
+            return k;}
+
+        static std::size_t capacity (const type& r) {
+            return r.capacity();}
+
+        static std::size_t bytes (const type& r) {
+            return r.capacity() * sizeof(V);}};};
+
+/**
+ * unique targets in a std::set
+ */
+struct setS {
+    template <typename V>
+    struct row {
+        typedef set<V> type;
+
+        static bool insert (type& r, V v) {
+            return r.insert(v).second;}
+
+        static std::size_t count (const type& r, V v) {
+            return r.count(v);}
+
+        static std::size_t erase (type& r, V v) {
+            return r.erase(v);}
+
+        template <typename RI>
+        static std::size_t merge (type& r, RI b, RI e) {
+            const std::size_t old = r.size();
+            r.insert(b, e);
+            return r.size() - old;}
+
+        template <typename RI>
+        static std::size_t subtract (type& r, RI b, RI e) {
+            std::size_t k = 0;
+            for (; b != e; ++b)
+                k += r.erase(*b);
+            return k;}
+
+        static std::size_t drop (type& r, V v) {
+            if (r.empty() || *r.rbegin() < v)
+                return 0;
+            type u;
+            for (typename type::const_iterator i = r.begin(); i != r.end(); ++i)
+                if (*i != v)
+                    u.insert(u.end(), (v < *i) ? *i - 1 : *i);
+            const std::size_t k = r.size() - u.size();
+            r.swap(u);
+            return k;}
+
+        static std::size_t capacity (const type& r) {
+            return r.size();}
+
+        /**
+         * an estimate: a red-black tree node is a color, three links and the value, in 16 byte malloc chunks
+         */
+        static std::size_t bytes (const type& r) {
+            return r.size() * ((4 * sizeof(void*) + sizeof(V) + 15) / 16 * 16);}};};
+
+/**
+ * targets in a std::multiset; parallel edges are kept and add_edge always succeeds
+ */
+struct multisetS {
+    template <typename V>
+    struct row {
+        typedef multiset<V> type;
+
+        static bool insert (type& r, V v) {
+            r.insert(v);
+            return true;}
+
+        static std::size_t count (const type& r, V v) {
+            return r.count(v);}
+
+        static std::size_t erase (type& r, V v) {
+            return r.erase(v);}
+
+        template <typename RI>
+        static std::size_t merge (type& r, RI b, RI e) {
+            r.insert(b, e);
+            return e - b;}
+
+        template <typename RI>
+        static std::size_t subtract (type& r, RI b, RI e) {
+            std::size_t k = 0;
+            for (; b != e; ++b)
+                k += r.erase(*b);
+            return k;}
+
+        static std::size_t drop (type& r, V v) {
+            if (r.empty() || *r.rbegin() < v)
+                return 0;
+            type u;
+            for (typename type::const_iterator i = r.begin(); i != r.end(); ++i)
+                if (*i != v)
+                    u.insert(u.end(), (v < *i) ? *i - 1 : *i);
+            const std::size_t k = r.size() - u.size();
+            r.swap(u);
+            return k;}
+
+        static std::size_t capacity (const type& r) {
+            return r.size();}
+
+        /**
+         * an estimate: a red-black tree node is a color, three links and the value, in 16 byte malloc chunks
+         */
+        static std::size_t bytes (const type& r) {
+            return r.size() * ((4 * sizeof(void*) + sizeof(V) + 15) / 16 * 16);}};};
+
+template <typename VertexId>
+class basic_compressed_graph;
+
+// -----------------
+// basic_graph_delta
+// -----------------
+
+/**
+ * a batch of edge insertions and removals for apply_delta; a snapshot taken before the
+ * delta is not patched, so freeze the graph again to read it as a CompressedGraph
+ */
+template <typename VertexId = int>
+struct basic_graph_delta {
+    typedef pair<VertexId, VertexId> edge_descriptor;
+
+    vector<edge_descriptor> inserted;
+    vector<edge_descriptor> removed;};
+
+typedef basic_graph_delta<> GraphDelta;
+
+// ----------------
+// graph_statistics
+// ----------------
+
+/**
+ * what graph_stats reports about the memory and the shape of a graph
+ */
+struct graph_statistics {
+    std::size_t vertices;
+    std::size_t edges;
+    std::size_t vertex_table_bytes; // the row headers (or offsets) of every vertex
+    std::size_t row_bytes;          // heap memory of the out rows; an estimate for setS and multisetS
+    std::size_t in_row_bytes;       // heap memory of the in rows of a bidirectionalS graph
+    std::size_t total_bytes;
+    std::size_t degree_p50;
+    std::size_t degree_p99;
+    std::size_t degree_max;
+    vector<std::size_t> degree_histogram; // [0] counts out degree 0, [k] out degrees in [2^(k-1), 2^k)
+    double empty_vertex_ratio;            // vertices without out edges / vertices
+    double load_factor;                   // stored targets / target slots allocated by the rows
+
+    graph_statistics () :
+            vertices(0),
+            edges(0),
+            vertex_table_bytes(0),
+            row_bytes(0),
+            in_row_bytes(0),
+            total_bytes(0),
+            degree_p50(0),
+            degree_p99(0),
+            degree_max(0),
+            degree_histogram(),
+            empty_vertex_ratio(0),
+            load_factor(1)
+        {}};
+
+/**
+ * fills in the degree fields of s from the out degree of every vertex
+ * @param d the out degrees, reordered by the call
+ */
+inline void summarize_degrees (vector<std::size_t>& d, graph_statistics& s) {
+    s.vertices = d.size();
+    if (d.empty())
+        return;
+    std::size_t empty = 0;
+    for (vector<std::size_t>::const_iterator i = d.begin(); i != d.end(); ++i) {
+        std::size_t k = 0;
+        while ((*i >> k) != 0)
+            ++k;
+        if (k >= s.degree_histogram.size())
+            s.degree_histogram.resize(k + 1);
+        ++s.degree_histogram[k];
+        empty += (*i == 0);}
+    s.empty_vertex_ratio = double(empty) / d.size();
+    // nearest rank: the p-th percentile is the ceil(p * n / 100)-th smallest degree
+    const std::size_t p50 = (d.size() * 50 + 99) / 100 - 1;
+    const std::size_t p99 = (d.size() * 99 + 99) / 100 - 1;
+    nth_element(d.begin(), d.begin() + p50, d.end());
+    s.degree_p50 = d[p50];
+    nth_element(d.begin(), d.begin() + p99, d.end());
+    s.degree_p99 = d[p99];
+    s.degree_max = *max_element(d.begin(), d.end());}
+
+// -----------
+// basic_graph
+// -----------
+
+/**
+ * adjacency list graph whose layout is chosen at compile time
+ * @param VertexId the integral type of a vertex_descriptor, e.g. int, unsigned or uint64_t
+ * @param Directedness directedS, undirectedS or bidirectionalS
+ * @param EdgeContainer flat_setS, setS or multisetS
+ */
+template <typename VertexId = int, typename Directedness = directedS, typename EdgeContainer = flat_setS>
+class basic_graph {
     public:
         // --------
         // typedefs
         // --------
 
-        typedef int vertex_descriptor;
+        typedef VertexId vertex_descriptor;
         typedef pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
 
+        typedef Directedness  directed_category;
+        typedef EdgeContainer edge_container;
 
         typedef std::size_t vertices_size_type;
         typedef std::size_t edges_size_type;
-        typedef set<edge_descriptor> edge_set;
+
+        /**
+         * one row of the adjacency list: the targets of a vertex
+         */
+        typedef typename EdgeContainer::template row<vertex_descriptor> row_policy;
+        typedef typename row_policy::type edge_set;
 
 
          // ------------
@@ -57,6 +401,8 @@ class Graph {
         class vertex_iterator : public iterator<bidirectional_iterator_tag, vertex_descriptor>
         {
             public:
+                typedef typename iterator<bidirectional_iterator_tag, vertex_descriptor>::difference_type difference_type;
+
                 /**
                  * Checks if two vertex_iterators are equal.
                  * @param rhs first vertex_iterator
@@ -89,7 +435,7 @@ class Graph {
 
                     
             private:
-                Graph* _g;
+                basic_graph* _g;
                 vertex_descriptor _i;
             public:
                 /**
@@ -97,7 +443,7 @@ class Graph {
                  * @param g pointer to graph being itearted on.
                  * @param i vertex position to start at.
                  */
-                vertex_iterator(Graph* g, const vertex_descriptor& i) :
+                vertex_iterator(basic_graph* g, const vertex_descriptor& i) :
                     _g(g),
                     _i(i)
                     {}
@@ -186,15 +532,15 @@ class Graph {
                     return (rhs._g == lhs._g) && (rhs._i == lhs._i);
                 }
             private:
-                Graph* _g;
-                edge_set::iterator _i;
+                basic_graph* _g;
+                typename edge_set::const_iterator _i;
             public:
                 /**
                  * Constructor for adjacency_iterator
                  * @param g pointer to graph being itearted on.
-                 * @param i an edge_set iterator pointing to set of edges for this vertex
+                 * @param i an edge_set iterator pointing into the row of targets for this vertex
                  */
-                adjacency_iterator(Graph* g, const edge_set::iterator& i) :
+                adjacency_iterator(basic_graph* g, const typename edge_set::const_iterator& i) :
                     _g(g),
                     _i(i)
                     {}
@@ -203,7 +549,7 @@ class Graph {
                  * @return const reference to a vertex adjacent to this vertex
                  */
                 const vertex_descriptor& operator * () {
-                    return (*_i).second;
+                    return *_i;
                 }
                 /**
                  * Pre-increment on adjacency_iterator.
@@ -237,7 +583,7 @@ class Graph {
         // ------------
         // edge_iterator class
         // ------------
-        class edge_iterator : public iterator<forward_iterator_tag, edge_descriptor>
+        class edge_iterator : public iterator<bidirectional_iterator_tag, edge_descriptor>
         {
             public:
                 /**
@@ -251,26 +597,65 @@ class Graph {
                 }
             private:
                 /**
-                 * moves the state of the iterator forward.  Used by post and pre-increment
-                 * @return void
+                 * Invariant: either _e points into row _i, or _i is the last row and _e is its end.
+                 * @return true if the iterator is past the last edge
                  */
-                void next() {
-                    if((unsigned int)_i == _g->_g.size()-1 && (_e == _g->_g[_g->_g.size()-1].end())) { //|| _e == --_g->_g[_g->_g.size()-1].end())) {
-                        return; //_e = _g->_g[_g->_g.size()-1].end();
-                    }else if((_e != _g->_g[_i].end())) {
-                        ++_e;
-                        if((_e == _g->_g[_i].end())) next();
-                    }else{
+                bool at_end() const {
+                    return (vertices_size_type)_i == _g->_g.size()-1 && _e == _g->_g[_i].end();
+                }
+
+                /**
+                 * moves _i forward past empty rows until the invariant holds; a sweep skips each row once
+                 */
+                void settle() {
+                    while(_e == _g->_g[_i].end() && (vertices_size_type)_i != _g->_g.size()-1) {
                         ++_i;
                         _e = _g->_g[_i].begin();
-                        if(_g->_g[_i].empty()) next();
                     }
                 }
 
+                /**
+                 * moves the state of the iterator forward one stored target.  Used by post and pre-increment
+                 * @return void
+                 */
+                void next() {
+                    if(at_end()) return;
+                    ++_e;
+                    settle();
+                }
+
+                /**
+                 * moves the state of the iterator back one stored target.  Used by post and pre-decrement
+                 * @return void
+                 */
+                void prev() {
+                    while(_e == _g->_g[_i].begin()) {
+                        --_i;
+                        _e = _g->_g[_i].end();
+                    }
+                    --_e;
+                }
+
+                /**
+                 * an undirected edge is stored in both rows; only the copy with source <= target is listed
+                 */
+                void skip() {
+                    if(Directedness::is_directed) return;
+                    while(!at_end() && *_e < _i) next();
+                }
+
+                /**
+                 * skip() for operator --
+                 */
+                void skip_back() {
+                    if(Directedness::is_directed) return;
+                    while(*_e < _i) prev();
+                }
+
 
-                Graph* _g;
+                basic_graph* _g;
                 vertex_descriptor _i;
-                edge_set::iterator _e;
+                typename edge_set::const_iterator _e;
             public:
                  /**
                  * Constructor for edge_iterator
@@ -278,17 +663,20 @@ class Graph {
                  * @param i the starting vertex.
                  * @param e starting edge to begin iteration on.
                  */
-                edge_iterator(Graph* g, const vertex_descriptor& i, const edge_set::iterator& e) :
+                edge_iterator(basic_graph* g, const vertex_descriptor& i, const typename edge_set::const_iterator& e) :
                     _g(g),
                     _i(i),
-                    _e(e)
-                    {}
+                    _e(e) {
+                    if(_g->_g.empty()) return;
+                    settle();
+                    skip();
+                    }
                 /**
                  * Dereferences edge_iterator
                  * @return const reference to an edge_descriptor
                  */
                 edge_descriptor operator * () {
-                    return *_e;
+                    return edge_descriptor(_i, *_e);
                 }
                 /**
                  * Pre-increment on edge iterator.
@@ -296,6 +684,7 @@ class Graph {
                  */
                 edge_iterator& operator ++ () {
                     next();
+                    skip();
                     return *this;
                 }
                 /**
@@ -304,7 +693,7 @@ class Graph {
                  */
                 edge_iterator operator ++ (int) {
                     edge_iterator temp = *this;
-                    next();
+                    ++*this;
                     return temp;
                 }
 
@@ -313,7 +702,8 @@ class Graph {
                  * @return reference to self (*this)
                  */
                 edge_iterator& operator -- () {
-                    next();
+                    prev();
+                    skip_back();
                     return *this;
                 }
                 /**
@@ -322,12 +712,79 @@ class Graph {
                  */
                 edge_iterator operator -- (int) {
                     edge_iterator temp = *this;
-                    next();
+                    --*this;
                     return temp;
                 }
 
         };
 
+        // ------------
+        // in_edge_iterator class
+        // ------------
+        class in_edge_iterator : public iterator<bidirectional_iterator_tag, edge_descriptor>
+        {
+            public:
+                /**
+                 * Checks if two in_edge_iterators are equal.
+                 * @param rhs first in_edge_iterator
+                 * @param lhs second in_edge_iterator
+                 * @return true if equal, false if not
+                 */
+                friend bool operator == (const in_edge_iterator& rhs, const in_edge_iterator& lhs) {
+                    return (rhs._v == lhs._v) && (rhs._i == lhs._i);
+                }
+            private:
+                vertex_descriptor _v;
+                typename edge_set::const_iterator _i;
+            public:
+                /**
+                 * Constructor for in_edge_iterator
+                 * @param v the target of every edge
+                 * @param i an iterator into the row of sources of v
+                 */
+                in_edge_iterator(const vertex_descriptor& v, const typename edge_set::const_iterator& i) :
+                    _v(v),
+                    _i(i)
+                    {}
+                /**
+                 * Dereferences in_edge_iterator
+                 * @return the edge from the current source to v
+                 */
+                edge_descriptor operator * () const {
+                    return edge_descriptor(*_i, _v);
+                }
+                /**
+                 * Pre-increment on in_edge_iterator.
+                 * @return reference to self (*this)
+                 */
+                in_edge_iterator& operator ++ () {
+                    ++_i;
+                    return *this;
+                }
+                /**
+                 * Post-increment on in_edge_iterator.
+                 * @return copy of this iterator before increment
+                 */
+                in_edge_iterator operator ++ (int) {
+                    in_edge_iterator temp = *this;
+                    ++_i;
+                    return temp;
+                }
+                /**
+                 * Pre-decrement on in_edge_iterator.
+                 * @return reference to self (*this)
+                 */
+                in_edge_iterator& operator -- () {
+                    --_i;
+                    return *this;
+                }
+        };
+
+        /**
+         * predecessors are rows of the same type, so they are read with the same iterator
+         */
+        typedef adjacency_iterator inv_adjacency_iterator;
+
     public:
         // --------
         // add_edge
@@ -339,14 +796,16 @@ class Graph {
          * @param g the graph for which to add the edge
          * @return returns a pair of an edge_descriptor and a boolean for successful or not
          */
-        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor a, vertex_descriptor b, Graph& g) {
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor a, vertex_descriptor b, basic_graph& g) {
+            GRAPH_PROBE(add_edge);
             edge_descriptor e(a, b);
-	    vertex_descriptor z = max(a,b) + 1;
-            bool bl = false;
-	    if((unsigned)z > num_vertices(g)){ while((unsigned)z > num_vertices(g)){ add_vertex(g);} bl = true; }
-	    if(bl){ g._g[a].insert(e); ++g._numEdges; return make_pair(e,true); } 
-            else if(g._g[a].find(e) == g._g[a].end()){  g._g[a].insert(e); ++g._numEdges; return make_pair(e, true); }
-            else return make_pair(e, false);
+	    vertices_size_type z = (vertices_size_type)max(a,b) + 1;
+	    if(z > num_vertices(g)){ GRAPH_COUNT(add_edge_grow); g.resize(z); }
+            if(!row_policy::insert(g._g[a], b)) return make_pair(e, false);
+            if(!Directedness::is_directed && a != b) row_policy::insert(g._g[b], a);
+            if(Directedness::has_in_edges) row_policy::insert(g._in[b], a);
+            ++g._numEdges;
+            return make_pair(e, true);
         }
 
         // ----------
@@ -357,11 +816,164 @@ class Graph {
          * @param g graph for which to add the vertex
          * @return returns the vertex_descriptor for the new vertex
          */
-        friend vertex_descriptor add_vertex (Graph& g) {
-            g._g.push_back(set<edge_descriptor>());
+        friend vertex_descriptor add_vertex (basic_graph& g) {
+            g.resize(g._g.size() + 1);
             return g._g.size()-1;
         }
 
+        // ---------
+        // add_edges
+        // ---------
+
+        /**
+         * Inserts a range of edges in one pass: _g is sized once, the edges are grouped by
+         * source with a counting sort, and each row is sorted and merged into its existing
+         * targets by the row policy (which deduplicates unless it is multisetS). Rows are
+         * merged on up to threads threads.
+         * @param first iterator to the first edge_descriptor to add
+         * @param last iterator past the last edge_descriptor to add
+         * @param g the graph for which to add the edges
+         * @param threads the number of threads used to merge rows
+         * @return returns the number of edges that were not already in g
+         */
+        template <typename FI>
+        friend edges_size_type add_edges (FI first, FI last, basic_graph& g, unsigned threads = 1) {
+            vertices_size_type n = num_vertices(g);
+            for (FI i = first; i != last; ++i)
+                n = max(n, (vertices_size_type)max(i->first, i->second) + 1);
+            if(n > num_vertices(g)){ g.resize(n); }
+
+            // an undirected edge adds two targets, a self loop one
+            const std::pair<edges_size_type, edges_size_type> a = merge_rows(g._g, first, last, false, !Directedness::is_directed, threads);
+            const edges_size_type m = Directedness::is_directed ? a.first : (a.first - a.second) / 2 + a.second;
+            if (Directedness::has_in_edges)
+                merge_rows(g._in, first, last, true, false, threads);
+            g._numEdges += m;
+            return m;}
+
+        // ------------
+        // remove_edges
+        // ------------
+
+        /**
+         * Removes a range of edges in one pass, grouped by source like add_edges; edges
+         * with an endpoint outside g are ignored. With multisetS every parallel copy goes.
+         * @param first iterator to the first edge_descriptor to remove
+         * @param last iterator past the last edge_descriptor to remove
+         * @param g the graph from which to remove the edges
+         * @param threads the number of threads used to subtract rows
+         * @return returns the number of edges removed
+         */
+        template <typename FI>
+        friend edges_size_type remove_edges (FI first, FI last, basic_graph& g, unsigned threads = 1) {
+            vector<edge_descriptor> v;
+            for (FI i = first; i != last; ++i)
+                if ((vertices_size_type)max(i->first, i->second) < num_vertices(g))
+                    v.push_back(*i);
+            const std::pair<edges_size_type, edges_size_type> a = merge_rows(g._g, v.begin(), v.end(), false, !Directedness::is_directed, threads, true);
+            const edges_size_type m = Directedness::is_directed ? a.first : (a.first - a.second) / 2 + a.second;
+            if (Directedness::has_in_edges)
+                merge_rows(g._in, v.begin(), v.end(), true, false, threads, true);
+            g._numEdges -= m;
+            return m;}
+
+        // -----------
+        // apply_delta
+        // -----------
+
+        /**
+         * applies d.removed and then d.inserted, each as one bulk pass over the rows it touches
+         * @param d the batch of changes
+         * @param g the graph to change
+         * @param threads the number of threads used per pass
+         * @return returns the number of edges added and the number removed
+         */
+        friend std::pair<edges_size_type, edges_size_type> apply_delta (const basic_graph_delta<vertex_descriptor>& d, basic_graph& g, unsigned threads = 1) {
+            const edges_size_type r = remove_edges(d.removed.begin(), d.removed.end(), g, threads);
+            const edges_size_type a = add_edges(d.inserted.begin(), d.inserted.end(), g, threads);
+            return std::make_pair(a, r);}
+
+        // -----------
+        // remove_edge
+        // -----------
+
+        /**
+         * removes the edge (a, b), or every copy of it with multisetS; does nothing if there is none
+         * @param a vertex_descriptor of the source
+         * @param b vertex_descriptor of the target
+         * @param g the graph from which to remove the edge
+         */
+        friend void remove_edge (vertex_descriptor a, vertex_descriptor b, basic_graph& g) {
+            if ((vertices_size_type)max(a, b) >= num_vertices(g))
+                return;
+            const edges_size_type k = row_policy::erase(g._g[a], b);
+            if (k == 0)
+                return;
+            if (!Directedness::is_directed && a != b)
+                row_policy::erase(g._g[b], a);
+            if (Directedness::has_in_edges)
+                row_policy::erase(g._in[b], a);
+            g._numEdges -= k;}
+
+        /**
+         * @param e edge_descriptor of the edge to remove
+         * @param g the graph from which to remove the edge
+         */
+        friend void remove_edge (edge_descriptor e, basic_graph& g) {
+            remove_edge(e.first, e.second, g);}
+
+        // ------------
+        // clear_vertex
+        // ------------
+
+        /**
+         * removes every edge into or out of v. Without in-edge rows, a directed graph has to
+         * scan every row for v, as boost::adjacency_list does.
+         * @param v vertex_descriptor of the vertex to clear
+         * @param g the graph
+         */
+        friend void clear_vertex (vertex_descriptor v, basic_graph& g) {
+            edge_set& r = g._g[v];
+            edges_size_type k = r.size();
+            if (!Directedness::is_directed) {
+                for (typename edge_set::const_iterator i = r.begin(); i != r.end(); ++i)
+                    if (*i != v)
+                        row_policy::erase(g._g[*i], v);}
+            else if (Directedness::has_in_edges) {
+                for (typename edge_set::const_iterator i = r.begin(); i != r.end(); ++i)
+                    if (*i != v)
+                        row_policy::erase(g._in[*i], v);
+                for (typename edge_set::const_iterator i = g._in[v].begin(); i != g._in[v].end(); ++i)
+                    if (*i != v)
+                        k += row_policy::erase(g._g[*i], v);
+                g._in[v].clear();}
+            else {
+                for (vertices_size_type u = 0; u != g._g.size(); ++u)
+                    if (u != (vertices_size_type)v)
+                        k += row_policy::erase(g._g[u], v);}
+            r.clear();
+            g._numEdges -= k;}
+
+        // -------------
+        // remove_vertex
+        // -------------
+
+        /**
+         * clears v and removes it; every vertex above v moves down by one, as with
+         * boost::adjacency_list<..., vecS, ...>, so all rows are renumbered in O(V + E)
+         * @param v vertex_descriptor of the vertex to remove
+         * @param g the graph
+         */
+        friend void remove_vertex (vertex_descriptor v, basic_graph& g) {
+            clear_vertex(v, g);
+            g._g.erase(g._g.begin() + v);
+            for (typename vector<edge_set>::iterator i = g._g.begin(); i != g._g.end(); ++i)
+                row_policy::drop(*i, v);
+            if (Directedness::has_in_edges) {
+                g._in.erase(g._in.begin() + v);
+                for (typename vector<edge_set>::iterator i = g._in.begin(); i != g._in.end(); ++i)
+                    row_policy::drop(*i, v);}}
+
         // -----------------
         // adjacent_vertices
         // -----------------
@@ -371,7 +983,8 @@ class Graph {
          * @param g the graph for which to get the adjacent vertices from
          * @return returns a pair of adjacency iterators for the beginning and end
          */
-        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, Graph& g) {
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, basic_graph& g) {
+            GRAPH_COUNT(adjacent_vertices); // only the iterator pair is built here, so there is nothing to time
             adjacency_iterator b(&g, g._g[v].begin());
             adjacency_iterator e(&g, g._g[v].end());
             return std::make_pair(b, e);
@@ -387,10 +1000,11 @@ class Graph {
          * @param g graph for which to get the edge from 
          * @return returns a pair of an edge_descriptor and a boolean
          */
-        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor a, vertex_descriptor b, const Graph& g) {
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor a, vertex_descriptor b, const basic_graph& g) {
+            GRAPH_PROBE(edge);
             edge_descriptor e(a, b);
-	    if((unsigned)a > num_vertices(g) ||(unsigned)b > num_vertices(g)){ return make_pair(e, false); }
-            return make_pair(e, g._g[a].find(e) != g._g[a].end());
+	    if((vertices_size_type)a >= num_vertices(g) ||(vertices_size_type)b >= num_vertices(g)){ return make_pair(e, false); }
+            return make_pair(e, row_policy::count(g._g[a], b) != 0);
         }
 
         // -----
@@ -401,22 +1015,50 @@ class Graph {
          * @param g the graph for which to get the iterator over edges from 
          * @return returns a pair of edge_iterators for the beginning and the end
          */
-        friend std::pair<edge_iterator, edge_iterator> edges (Graph& g) {
+        friend std::pair<edge_iterator, edge_iterator> edges (basic_graph& g) {
+            GRAPH_COUNT(edges);
             if(g._numEdges == 0 && g._g.size() == 0){
-                edge_set s;
-                edge_iterator c(&g, 0, s.begin());
-                edge_iterator d(&g, 0, s.begin());
-                return make_pair(c,d);
+                edge_iterator c(&g, 0, typename edge_set::const_iterator());
+                return make_pair(c,c);
             }
-            unsigned int i = 0;
-            while(g._g[i].empty() && i < g._g.size()) { i++; }
-            edge_iterator b(&g, i, g._g[i].begin());
+            edge_iterator b(&g, 0, g._g[0].begin());
             edge_iterator e(&g, g._g.size()-1, g._g[g._g.size()-1].end());
-            if(g._numEdges == 0){
-                return make_pair(e, e);
-            }
             return std::make_pair(b, e);}
 
+        // -----------
+        // edge_ranges
+        // -----------
+
+        /**
+         * splits edges(g) into consecutive sub-ranges holding about the same number of edges
+         * (stored targets, for undirected graphs), not the same number of vertices
+         * @param g the graph to split
+         * @param parts the number of sub-ranges
+         * @return returns parts pairs of edge_iterators; together they cover edges(g) in order
+         */
+        friend vector< std::pair<edge_iterator, edge_iterator> > edge_ranges (basic_graph& g, unsigned parts) {
+            parts = max(parts, 1u);
+            const std::pair<edge_iterator, edge_iterator> all = edges(g);
+            vector<edge_iterator> cuts(1, all.first);
+            edges_size_type stored = 0;
+            for (vertices_size_type v = 0; v != g._g.size(); ++v)
+                stored += g._g[v].size();
+            edges_size_type seen = 0;
+            vertices_size_type v = 0;
+            for (unsigned k = 1; k < parts; ++k) {
+                const edges_size_type want = stored * k / parts;
+                while (v != g._g.size() && seen + g._g[v].size() <= want)
+                    seen += g._g[v++].size();
+                if (v == g._g.size())
+                    cuts.push_back(all.second);
+                else
+                    cuts.push_back(edge_iterator(&g, v, std::next(g._g[v].begin(), want - seen)));}
+            cuts.push_back(all.second);
+            vector< std::pair<edge_iterator, edge_iterator> > r;
+            for (unsigned k = 0; k < parts; ++k)
+                r.push_back(std::make_pair(cuts[k], cuts[k + 1]));
+            return r;}
+
         // ---------
         // num_edges
         // ---------
@@ -425,7 +1067,7 @@ class Graph {
          * @param g the graph for which to get the number of edges from 
          * @return returns the number of edges in the graph
          */
-        friend edges_size_type num_edges (const Graph& g) {
+        friend edges_size_type num_edges (const basic_graph& g) {
             return g._numEdges;}
 
         // ------------
@@ -436,7 +1078,7 @@ class Graph {
          * @param g the graph for which to get the number of vertices from 
          * @return returns the number of vertices in the graph
          */
-        friend vertices_size_type num_vertices (const Graph& g) {
+        friend vertices_size_type num_vertices (const basic_graph& g) {
             return g._g.size();}
 
         // ------
@@ -448,7 +1090,7 @@ class Graph {
          * @param g the graph for which to get the source from
          * @return returns the main vertex in an edge
          */
-        friend vertex_descriptor source (edge_descriptor e, const Graph& g) {
+        friend vertex_descriptor source (edge_descriptor e, const basic_graph& g) {
             return e.first;}
 
         // ------
@@ -460,7 +1102,7 @@ class Graph {
          * @param g the graph for which to get the target from 
          * @return returns the secondary vertex in an edge
          */
-        friend vertex_descriptor target (edge_descriptor e, const Graph& g) {
+        friend vertex_descriptor target (edge_descriptor e, const basic_graph& g) {
             return e.second;}
 
         // ------
@@ -472,7 +1114,7 @@ class Graph {
          * @param g graph from which to get the vertex_descriptor from 
          * @return returns the vertex_descriptor at index i
          */
-        friend vertex_descriptor vertex (vertices_size_type i, const Graph& g) {
+        friend vertex_descriptor vertex (vertices_size_type i, const basic_graph& g) {
             return i;}
 
         // --------
@@ -483,16 +1125,163 @@ class Graph {
          * @param g graph form which to get the vertex iterators from 
          * @return returns a pair of vertex iterators which are the beginning and the end of the graph's vertices
          */
-        friend std::pair<vertex_iterator, vertex_iterator> vertices (Graph& g) {
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (basic_graph& g) {
             return make_pair(vertex_iterator(&g, 0), vertex_iterator(&g, g._g.size()));}
 
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v vertex_descriptor for which to count the out edges
+         * @param g the graph to count in
+         * @return returns the number of targets of v; for undirected graphs, its degree
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const basic_graph& g) {
+            return g._g[v].size();}
+
+        // ---------
+        // in_degree
+        // ---------
+
+        /**
+         * @param v vertex_descriptor for which to count the in edges
+         * @param g a bidirectionalS graph
+         * @return returns the number of sources of v, in O(1)
+         */
+        friend edges_size_type in_degree (vertex_descriptor v, const basic_graph& g) {
+            static_assert(Directedness::has_in_edges, "in_degree needs a bidirectionalS graph");
+            return g._in[v].size();}
+
+        // ---------------------
+        // inv_adjacent_vertices
+        // ---------------------
+
+        /**
+         * @param v vertex_descriptor for which you want the predecessors of
+         * @param g a bidirectionalS graph
+         * @return returns a pair of adjacency iterators over the sources of v, in order
+         */
+        friend std::pair<inv_adjacency_iterator, inv_adjacency_iterator> inv_adjacent_vertices (vertex_descriptor v, basic_graph& g) {
+            static_assert(Directedness::has_in_edges, "inv_adjacent_vertices needs a bidirectionalS graph");
+            return std::make_pair(inv_adjacency_iterator(&g, g._in[v].begin()), inv_adjacency_iterator(&g, g._in[v].end()));}
+
+        // --------
+        // in_edges
+        // --------
+
+        /**
+         * @param v vertex_descriptor for which you want the in edges of
+         * @param g a bidirectionalS graph
+         * @return returns a pair of in_edge_iterators over the edges (u, v), ordered by u
+         */
+        friend std::pair<in_edge_iterator, in_edge_iterator> in_edges (vertex_descriptor v, basic_graph& g) {
+            static_assert(Directedness::has_in_edges, "in_edges needs a bidirectionalS graph");
+            return std::make_pair(in_edge_iterator(v, g._in[v].begin()), in_edge_iterator(v, g._in[v].end()));}
+
+        // -----------
+        // graph_stats
+        // -----------
+
+        /**
+         * @param g the graph to measure
+         * @return returns the memory used by g, broken down by component, and its out degree distribution
+         */
+        friend graph_statistics graph_stats (const basic_graph& g) {
+            graph_statistics s;
+            vector<std::size_t> d;
+            d.reserve(g._g.size());
+            std::size_t slots = 0;
+            for (typename vector<edge_set>::const_iterator i = g._g.begin(); i != g._g.end(); ++i) {
+                d.push_back(i->size());
+                slots       += row_policy::capacity(*i);
+                s.row_bytes += row_policy::bytes(*i);}
+            for (typename vector<edge_set>::const_iterator i = g._in.begin(); i != g._in.end(); ++i)
+                s.in_row_bytes += row_policy::bytes(*i);
+            summarize_degrees(d, s);
+            s.edges              = g._numEdges;
+            s.vertex_table_bytes = (g._g.capacity() + g._in.capacity()) * sizeof(edge_set);
+            s.total_bytes        = sizeof(g) + s.vertex_table_bytes + s.row_bytes + s.in_row_bytes;
+            const std::size_t stored = accumulate(g._g.begin(), g._g.end(), std::size_t(0), [] (std::size_t k, const edge_set& r) {return k + r.size();});
+            s.load_factor = (slots == 0) ? 1.0 : double(stored) / slots;
+            return s;}
+
     private:
+        template <typename V>
+        friend class basic_compressed_graph;
+
         // ----
         // data
         // ----
 
         vector< edge_set > _g; // something like this
+        vector< edge_set > _in; // sources of each vertex; empty unless has_in_edges
         edges_size_type _numEdges;
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * grows the vertex set to n vertices
+         */
+        void resize (vertices_size_type n) {
+            _g.resize(n);
+            if (Directedness::has_in_edges)
+                _in.resize(n);}
+
+        // ----------
+        // merge_rows
+        // ----------
+
+        /**
+         * Groups [first, last) by row with a counting sort and merges each group into its row
+         * with the row policy, on up to threads threads.
+         * @param rows the rows to merge into, already large enough for every endpoint
+         * @param reversed if true, an edge (a, b) adds a to row b instead of b to row a
+         * @param symmetric if true, an edge (a, b) with a != b adds both b to row a and a to row b
+         * @param subtract if true, the groups are subtracted from their rows instead
+         * @return returns the number of targets added (or removed) and how many of them were self loops
+         */
+        template <typename FI>
+        static std::pair<edges_size_type, edges_size_type> merge_rows (vector<edge_set>& rows, FI first, FI last, bool reversed, bool symmetric, unsigned threads, bool subtract = false) {
+            const vertices_size_type n = rows.size();
+            vector<edges_size_type> offsets(n + 1, 0);
+            for (FI i = first; i != last; ++i) {
+                const vertex_descriptor a = reversed ? i->second : i->first;
+                const vertex_descriptor b = reversed ? i->first  : i->second;
+                ++offsets[a + 1];
+                if (symmetric && a != b)
+                    ++offsets[b + 1];}
+            partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            vector<vertex_descriptor> targets(offsets.back());
+            vector<edges_size_type> next(offsets.begin(), offsets.end() - 1);
+            for (FI i = first; i != last; ++i) {
+                const vertex_descriptor a = reversed ? i->second : i->first;
+                const vertex_descriptor b = reversed ? i->first  : i->second;
+                targets[next[a]++] = b;
+                if (symmetric && a != b)
+                    targets[next[b]++] = a;}
+
+            vector<edges_size_type> added(max(threads, 1u), 0);
+            vector<edges_size_type> loops(max(threads, 1u), 0);
+            parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned t) {
+                for (std::size_t v = b; v != e; ++v) {
+                    typename vector<vertex_descriptor>::iterator rb = targets.begin() + offsets[v];
+                    typename vector<vertex_descriptor>::iterator re = targets.begin() + offsets[v + 1];
+                    if (rb == re)
+                        continue;
+                    sort(rb, re);
+                    edge_set& r = rows[v];
+                    const std::size_t before = row_policy::count(r, v);
+                    if (subtract) {
+                        added[t] += row_policy::subtract(r, rb, re);
+                        loops[t] += before - row_policy::count(r, v);}
+                    else {
+                        added[t] += row_policy::merge(r, rb, re);
+                        loops[t] += row_policy::count(r, v) - before;}}});
+            return std::make_pair(accumulate(added.begin(), added.end(), edges_size_type(0)),
+                                  accumulate(loops.begin(), loops.end(), edges_size_type(0)));}
         // -----
         // valid
         // -----
@@ -501,7 +1290,7 @@ class Graph {
          * @return returns a boolean stating whether the condition is valid. This is when the graph is empty
          */
         bool valid () const {
-            return _g.size() == 0 && _numEdges == 0;}
+            return _g.size() == 0 && _in.size() == 0 && _numEdges == 0;}
 
     public:
 
@@ -512,13 +1301,670 @@ class Graph {
         /**
          * initializes the graph and calls valid to ensure this
          */
-        Graph () : _g(), _numEdges() {
+        basic_graph () : _g(), _in(), _numEdges() {
             assert(valid());}
 
+        /**
+         * builds the graph from a range of edges with add_edges
+         * @param first iterator to the first edge_descriptor
+         * @param last iterator past the last edge_descriptor
+         * @param threads the number of threads used to merge rows
+         */
+        template <typename FI>
+        basic_graph (FI first, FI last, unsigned threads = 1) : _g(), _in(), _numEdges() {
+            add_edges(first, last, *this, threads);}
+
         // Default copy, destructor, and copy assignment
         // Graph  (const Graph<T>&);
         // ~Graph ();
         // Graph& operator = (const Graph&);
     };
 
+/**
+ * the directed, int, flat row graph used throughout
+ */
+typedef basic_graph<> Graph;
+
+// ----------------------
+// basic_compressed_graph
+// ----------------------
+
+/**
+ * Immutable compressed sparse row (CSR) snapshot of a Graph.
+ * The targets of vertex v are stored sorted in _targets[_offsets[v], _offsets[v+1]),
+ * so adjacency scans walk contiguous memory and edge lookups are a binary search.
+ * The arrays are either owned by the snapshot or borrowed from _storage (e.g. a
+ * memory mapped file); copies share them. A snapshot of an undirected graph stores
+ * both directions of every edge, so it reads as the symmetric directed graph.
+ */
+template <typename VertexId = int>
+class basic_compressed_graph {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef VertexId vertex_descriptor;
+        typedef pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
+
+        typedef std::size_t vertices_size_type;
+        typedef std::size_t edges_size_type;
+
+        typedef const vertex_descriptor* adjacency_iterator;
+
+        // ------------
+        // vertex_iterator class
+        // ------------
+        class vertex_iterator : public iterator<bidirectional_iterator_tag, vertex_descriptor>
+        {
+            public:
+                /**
+                 * Checks if two vertex_iterators are equal.
+                 * @param rhs first vertex_iterator
+                 * @param lhs second vertex_iterator
+                 * @return true if equal, false if not
+                 */
+                friend bool operator == (const vertex_iterator& rhs, const vertex_iterator& lhs) {
+                    return rhs._i == lhs._i;
+                }
+            private:
+                vertex_descriptor _i;
+            public:
+                /**
+                 * Constructor for vertex_iterator
+                 * @param i vertex position to start at.
+                 */
+                explicit vertex_iterator(const vertex_descriptor& i) :
+                    _i(i)
+                    {}
+                /**
+                 * Dereferences vertex_iterator
+                 * @return const reference to vertex
+                 */
+                const vertex_descriptor& operator * () const {
+                    return _i;
+                }
+                /**
+                 * Pre-increment on iterator.
+                 * @return reference to self (*this)
+                 */
+                vertex_iterator& operator ++ () {
+                    ++_i;
+                    return *this;
+                }
+                /**
+                 * Post-increment on iterator.
+                 * @return copy of this iterator before increment
+                 */
+                vertex_iterator operator ++ (int) {
+                    vertex_iterator temp = *this;
+                    ++_i;
+                    return temp;
+                }
+                /**
+                 * Pre-decrement on iterator.
+                 * @return reference to self (*this)
+                 */
+                vertex_iterator& operator -- () {
+                    --_i;
+                    return *this;
+                }
+                /**
+                 * Post-decrement on iterator.
+                 * @return copy of this iterator before decrement
+                 */
+                vertex_iterator operator -- (int) {
+                    vertex_iterator temp = *this;
+                    --_i;
+                    return temp;
+                }
+        };
+
+        // ------------
+        // edge_iterator class
+        // ------------
+        class edge_iterator : public iterator<forward_iterator_tag, edge_descriptor>
+        {
+            public:
+                /**
+                 * Checks if two edge_iterators are equal.
+                 * @param rhs first edge_iterator
+                 * @param lhs second edge_iterator
+                 * @return true if equal, false if not
+                 */
+                friend bool operator == (const edge_iterator& rhs, const edge_iterator& lhs) {
+                    return (rhs._g == lhs._g) && (rhs._e == lhs._e);
+                }
+            private:
+                /**
+                 * moves _i forward until the row containing position _e is reached
+                 */
+                void settle() {
+                    while (_e < _g->_m && _g->_offsets[_i + 1] <= _e)
+                        ++_i;
+                }
+
+                const basic_compressed_graph* _g;
+                vertex_descriptor _i;
+                edges_size_type _e;
+            public:
+                /**
+                 * Constructor for edge_iterator
+                 * @param g pointer to graph being iterated on.
+                 * @param e position in the targets array to begin iteration on.
+                 */
+                edge_iterator(const basic_compressed_graph* g, edges_size_type e) :
+                    _g(g),
+                    _i(0),
+                    _e(e) {
+                    if (_e < _g->_m)
+                        _i = static_cast<vertex_descriptor>(upper_bound(_g->_offsets, _g->_offsets + _g->_n + 1, _e) - _g->_offsets) - 1;
+                    }
+                /**
+                 * Dereferences edge_iterator
+                 * @return the edge_descriptor at the current position
+                 */
+                edge_descriptor operator * () const {
+                    return edge_descriptor(_i, _g->_targets[_e]);
+                }
+                /**
+                 * Pre-increment on edge iterator.
+                 * @return reference to self (*this)
+                 */
+                edge_iterator& operator ++ () {
+                    ++_e;
+                    settle();
+                    return *this;
+                }
+                /**
+                 * Post-increment on edge iterator.
+                 * @return copy of this iterator before increment
+                 */
+                edge_iterator operator ++ (int) {
+                    edge_iterator temp = *this;
+                    ++*this;
+                    return temp;
+                }
+        };
+
+    public:
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param v vertex_descriptor for which you want the adjacent vertices of
+         * @param g the graph for which to get the adjacent vertices from
+         * @return returns a pair of adjacency iterators over the contiguous row of v
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const basic_compressed_graph& g) {
+            return std::make_pair(g._targets + g._offsets[v], g._targets + g._offsets[v + 1]);}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v vertex_descriptor of the source vertex
+         * @param g the graph
+         * @return returns the number of edges out of v, the length of its row
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const basic_compressed_graph& g) {
+            return g._offsets[v + 1] - g._offsets[v];}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * @param a vertex_descriptor of the main vertex
+         * @param b vertex_descriptor of the secondary vertex
+         * @param g graph for which to get the edge from
+         * @return returns a pair of an edge_descriptor and a boolean, found by binary search over the row of a
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor a, vertex_descriptor b, const basic_compressed_graph& g) {
+            edge_descriptor e(a, b);
+            if ((vertices_size_type)a >= num_vertices(g) || (vertices_size_type)b >= num_vertices(g))
+                return make_pair(e, false);
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(a, g);
+            return make_pair(e, binary_search(p.first, p.second, b));}
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * @param g the graph for which to get the iterator over edges from
+         * @return returns a pair of edge_iterators for the beginning and the end
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const basic_compressed_graph& g) {
+            return std::make_pair(edge_iterator(&g, 0), edge_iterator(&g, g._m));}
+
+        // -----------
+        // edge_ranges
+        // -----------
+
+        /**
+         * @param g the graph to split
+         * @param parts the number of sub-ranges
+         * @return returns parts consecutive pairs of edge_iterators with the same number of edges, give or take one
+         */
+        friend vector< std::pair<edge_iterator, edge_iterator> > edge_ranges (const basic_compressed_graph& g, unsigned parts) {
+            parts = max(parts, 1u);
+            vector< std::pair<edge_iterator, edge_iterator> > r;
+            for (unsigned k = 0; k < parts; ++k)
+                r.push_back(std::make_pair(edge_iterator(&g, g._m * k / parts), edge_iterator(&g, g._m * (k + 1) / parts)));
+            return r;}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param g the graph for which to get the number of edges from
+         * @return returns the number of edges in the graph
+         */
+        friend edges_size_type num_edges (const basic_compressed_graph& g) {
+            return g._m;}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g the graph for which to get the number of vertices from
+         * @return returns the number of vertices in the graph
+         */
+        friend vertices_size_type num_vertices (const basic_compressed_graph& g) {
+            return g._n;}
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param e edge_descriptor from which to get the source
+         * @param g the graph for which to get the source from
+         * @return returns the main vertex in an edge
+         */
+        friend vertex_descriptor source (edge_descriptor e, const basic_compressed_graph& g) {
+            return e.first;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param e edge_descriptor from which to get the target
+         * @param g the graph for which to get the target from
+         * @return returns the secondary vertex in an edge
+         */
+        friend vertex_descriptor target (edge_descriptor e, const basic_compressed_graph& g) {
+            return e.second;}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * @param i index of the graph to get the vertex_descriptor from
+         * @param g graph from which to get the vertex_descriptor from
+         * @return returns the vertex_descriptor at index i
+         */
+        friend vertex_descriptor vertex (vertices_size_type i, const basic_compressed_graph& g) {
+            return i;}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param g graph from which to get the vertex iterators from
+         * @return returns a pair of vertex iterators which are the beginning and the end of the graph's vertices
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const basic_compressed_graph& g) {
+            return make_pair(vertex_iterator(0), vertex_iterator(num_vertices(g)));}
+
+    private:
+        // ----
+        // data
+        // ----
+
+        /**
+         * owned backing store for snapshots built in memory
+         */
+        struct arrays {
+            vector<edges_size_type>   offsets;
+            vector<vertex_descriptor> targets;};
+
+        shared_ptr<const void>   _storage; // keeps _offsets and _targets alive
+        const edges_size_type*   _offsets; // num_vertices + 1 row boundaries
+        const vertex_descriptor* _targets; // num_edges targets, sorted within each row
+        vertices_size_type       _n;
+        edges_size_type          _m;
+
+        // -----
+        // valid
+        // -----
+
+        /**
+         * @return returns a boolean stating whether the offsets describe the targets array
+         */
+        bool valid () const {
+            return (_offsets != 0) && (_offsets[0] == 0) && (_offsets[_n] == _m);}
+
+        /**
+         * points the snapshot at an owned arrays object
+         */
+        void adopt (const shared_ptr<arrays>& a) {
+            _storage = a;
+            _offsets = a->offsets.data();
+            _targets = a->targets.data();
+            _n       = a->offsets.size() - 1;
+            _m       = a->targets.size();}
+
+    public:
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * builds an empty snapshot
+         */
+        basic_compressed_graph () : _storage(), _offsets(), _targets(), _n(), _m() {
+            shared_ptr<arrays> a = make_shared<arrays>();
+            a->offsets.push_back(0);
+            adopt(a);
+            assert(valid());}
+
+        /**
+         * packs every row of g into the offsets and targets arrays
+         * @param g the graph to take a snapshot of
+         */
+        template <typename D, typename C>
+        explicit basic_compressed_graph (const basic_graph<VertexId, D, C>& g) : _storage(), _offsets(), _targets(), _n(), _m() {
+            typedef typename basic_graph<VertexId, D, C>::edge_set edge_set;
+            shared_ptr<arrays> a = make_shared<arrays>();
+            a->offsets.reserve(g._g.size() + 1);
+            a->targets.reserve(g._numEdges);
+            a->offsets.push_back(0);
+            for (typename vector<edge_set>::const_iterator r = g._g.begin(); r != g._g.end(); ++r) {
+                a->targets.insert(a->targets.end(), r->begin(), r->end());
+                a->offsets.push_back(a->targets.size());}
+            adopt(a);
+            assert(valid());}
+
+        /**
+         * wraps arrays owned by someone else without copying them
+         * @param storage keeps offsets and targets alive for as long as any copy of the snapshot exists
+         * @param offsets n + 1 nondecreasing row boundaries starting at 0
+         * @param targets offsets[n] targets, sorted within each row
+         * @param n the number of vertices
+         */
+        basic_compressed_graph (const shared_ptr<const void>& storage, const edges_size_type* offsets, const vertex_descriptor* targets, vertices_size_type n) :
+                _storage(storage),
+                _offsets(offsets),
+                _targets(targets),
+                _n(n),
+                _m(offsets[n]) {
+            assert(valid());}
+
+        // Default copy, destructor, and copy assignment
+    };
+
+/**
+ * the snapshot type of Graph
+ */
+typedef basic_compressed_graph<> CompressedGraph;
+
+// ------
+// freeze
+// ------
+
+/**
+ * @param g the graph to take an immutable snapshot of
+ * @return returns a basic_compressed_graph with the same vertices and edges as g
+ */
+template <typename V, typename D, typename C>
+basic_compressed_graph<V> freeze (const basic_graph<V, D, C>& g) {
+    return basic_compressed_graph<V>(g);}
+
+// -----------
+// graph_stats
+// -----------
+
+/**
+ * @param g the snapshot to measure; its arrays have no slack, so the load factor is 1
+ * @return returns the memory used by g, broken down by component, and its out degree distribution
+ */
+template <typename V>
+graph_statistics graph_stats (const basic_compressed_graph<V>& g) {
+    graph_statistics s;
+    vector<std::size_t> d;
+    d.reserve(num_vertices(g));
+    for (std::size_t v = 0; v != num_vertices(g); ++v) {
+        const std::pair<const V*, const V*> p = adjacent_vertices(v, g);
+        d.push_back(p.second - p.first);}
+    summarize_degrees(d, s);
+    s.edges              = num_edges(g);
+    s.vertex_table_bytes = (num_vertices(g) + 1) * sizeof(std::size_t);
+    s.row_bytes          = num_edges(g) * sizeof(V);
+    s.total_bytes        = sizeof(g) + s.vertex_table_bytes + s.row_bytes;
+    return s;}
+
+// ----------------------
+// parallel_for_each_edge
+// ----------------------
+
+/**
+ * calls f(edge_descriptor) for every edge of g, on threads threads at once, each sweeping
+ * one of the balanced sub-ranges from edge_ranges
+ * @param g Graph or CompressedGraph
+ * @param f callable taking an edge_descriptor; it runs concurrently, so it must be thread safe
+ * @param threads the number of threads
+ */
+template <typename G, typename F>
+void parallel_for_each_edge (G& g, F f, unsigned threads) {
+    typedef typename G::edge_iterator edge_iterator;
+    const vector< std::pair<edge_iterator, edge_iterator> > r = edge_ranges(g, threads);
+    parallel_for(r.size(), r.size(), [&] (std::size_t b, std::size_t e, unsigned) {
+        for (; b != e; ++b)
+            for (edge_iterator i = r[b].first; i != r[b].second; ++i)
+                f(*i);});}
+
+// ---------
+// not_a_dag
+// ---------
+
+/**
+ * thrown by topological_sort when the graph has a cycle, like boost::not_a_dag
+ */
+struct not_a_dag : std::invalid_argument {
+    not_a_dag () :
+            std::invalid_argument("The graph must be a DAG.")
+        {}};
+
+// ------------------
+// depth_first_finish
+// ------------------
+
+/**
+ * Depth first search over every vertex in vertices order, visiting neighbors in adjacency
+ * order, with an explicit stack so deep graphs cannot overflow the call stack.
+ * @param g Graph or CompressedGraph
+ * @param finish called with each vertex when it finishes
+ * @return returns false as soon as a back edge (a cycle) is found, true otherwise
+ */
+template <typename G, typename F>
+bool depth_first_finish (G& g, F finish) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef std::pair<adjacency_iterator, adjacency_iterator> range;
+    enum {white, gray, black};
+
+    const std::size_t n = num_vertices(g);
+    vector<char> color(n, white);
+    vector< std::pair<vertex_descriptor, range> > stack;
+    for (std::size_t s = 0; s != n; ++s) {
+        if (color[s] != white)
+            continue;
+        color[s] = gray;
+        stack.push_back(std::make_pair(vertex_descriptor(s), adjacent_vertices(s, g)));
+        while (!stack.empty()) {
+            const vertex_descriptor u = stack.back().first;
+            range& r = stack.back().second;
+            if (r.first == r.second) {
+                color[u] = black;
+                finish(u);
+                stack.pop_back();
+                continue;}
+            const vertex_descriptor w = *r.first;
+            ++r.first;
+            if (color[w] == gray)
+                return false;
+            if (color[w] == white) {
+                color[w] = gray;
+                stack.push_back(std::make_pair(w, adjacent_vertices(w, g)));}}}
+    return true;}
+
+// ---------
+// has_cycle
+// ---------
+
+/**
+ * @param g the graph to check; self loops count as cycles
+ * @return returns true if g has a directed cycle
+ */
+template <typename V, typename D, typename C>
+bool has_cycle (basic_graph<V, D, C>& g) {
+    static_assert(D::is_directed, "has_cycle needs a directed graph; every undirected edge would count as a cycle");
+    return !depth_first_finish(g, [] (V) {});}
+
+/**
+ * @param g the graph to check; self loops count as cycles
+ * @return returns true if g has a directed cycle
+ */
+template <typename V>
+bool has_cycle (const basic_compressed_graph<V>& g) {
+    return !depth_first_finish(g, [] (V) {});}
+
+// ----------------
+// topological_sort
+// ----------------
+
+/**
+ * writes the vertices in reverse topological order (finish order), exactly as boost::topological_sort does
+ * @param g the graph to sort
+ * @param out output iterator receiving vertex_descriptors
+ * @throws not_a_dag if g has a cycle
+ */
+template <typename V, typename D, typename C, typename OI>
+void topological_sort (basic_graph<V, D, C>& g, OI out) {
+    static_assert(D::is_directed, "topological_sort needs a directed graph");
+    if (!depth_first_finish(g, [&out] (V v) {*out++ = v;}))
+        throw not_a_dag();}
+
+/**
+ * writes the vertices in reverse topological order (finish order), exactly as boost::topological_sort does
+ * @param g the graph to sort
+ * @param out output iterator receiving vertex_descriptors
+ * @throws not_a_dag if g has a cycle
+ */
+template <typename V, typename OI>
+void topological_sort (const basic_compressed_graph<V>& g, OI out) {
+    if (!depth_first_finish(g, [&out] (V v) {*out++ = v;}))
+        throw not_a_dag();}
+
+// -----------
+// kahn_finish
+// -----------
+
+/**
+ * Level synchronous Kahn's algorithm. In-degrees are counted with atomics across threads,
+ * then each frontier is split across threads, and a vertex joins the next frontier when
+ * its in-degree drops to zero. Frontiers smaller than grain are processed on the calling
+ * thread, so long chains do not pay for thread start up on every level.
+ * @param g Graph or CompressedGraph
+ * @param out output iterator receiving the vertices in reverse topological order
+ * @param threads the number of threads
+ * @param grain the smallest frontier that is split across threads
+ * @return returns false if g has a cycle, in which case nothing is written
+ */
+template <typename G, typename OI>
+bool kahn_finish (G& g, OI out, unsigned threads, std::size_t grain) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+
+    const std::size_t n = num_vertices(g);
+    const unsigned    k = max(threads, 1u);
+    vector< std::atomic<unsigned> > indegree(n);
+    parallel_for(n, k, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t v = b; v != e; ++v)
+            indegree[v].store(0, std::memory_order_relaxed);});
+    parallel_for(n, k, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t v = b; v != e; ++v) {
+            std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, g);
+            for (; p.first != p.second; ++p.first)
+                indegree[*p.first].fetch_add(1, std::memory_order_relaxed);}});
+
+    vector<vertex_descriptor> order;
+    order.reserve(n);
+    for (std::size_t v = 0; v != n; ++v)
+        if (indegree[v].load(std::memory_order_relaxed) == 0)
+            order.push_back(v);
+
+    vector< vector<vertex_descriptor> > next(k);
+    std::size_t level = 0;
+    while (level != order.size()) {
+        const std::size_t b = level;
+        const std::size_t e = order.size();
+        const unsigned    t = (e - b < grain) ? 1 : k;
+        parallel_for(e - b, t, [&] (std::size_t i, std::size_t j, unsigned c) {
+            next[c].clear();
+            for (; i != j; ++i) {
+                std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(order[b + i], g);
+                for (; p.first != p.second; ++p.first)
+                    if (indegree[*p.first].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        next[c].push_back(*p.first);}});
+        for (unsigned c = 0; c != t; ++c)
+            order.insert(order.end(), next[c].begin(), next[c].end());
+        level = e;}
+
+    if (order.size() != n)
+        return false;
+    copy(order.rbegin(), order.rend(), out);
+    return true;}
+
+// -------------------------
+// parallel_topological_sort
+// -------------------------
+
+/**
+ * the order of topological_sort computed with kahn_finish, level by level across threads
+ * @param g the graph to sort
+ * @param out output iterator receiving the vertices in reverse topological order, like topological_sort
+ * @param threads the number of threads
+ * @param grain the smallest frontier that is split across threads
+ * @throws not_a_dag if g has a cycle
+ */
+template <typename V, typename D, typename C, typename OI>
+void parallel_topological_sort (basic_graph<V, D, C>& g, OI out, unsigned threads, std::size_t grain = 1024) {
+    static_assert(D::is_directed, "parallel_topological_sort needs a directed graph");
+    if (!kahn_finish(g, out, threads, grain))
+        throw not_a_dag();}
+
+/**
+ * the order of topological_sort computed with kahn_finish, level by level across threads
+ * @param g the graph to sort
+ * @param out output iterator receiving the vertices in reverse topological order, like topological_sort
+ * @param threads the number of threads
+ * @param grain the smallest frontier that is split across threads
+ * @throws not_a_dag if g has a cycle
+ */
+template <typename V, typename OI>
+void parallel_topological_sort (const basic_compressed_graph<V>& g, OI out, unsigned threads, std::size_t grain = 1024) {
+    if (!kahn_finish(g, out, threads, grain))
+        throw not_a_dag();}
+
 #endif // Graph_h
@@ -0,0 +1,924 @@
+// ---------------------------------
+// projects/graph/GraphAlgorithms.h
+// ---------------------------------
+
+#ifndef GraphAlgorithms_h
+#define GraphAlgorithms_h
+
+// --------
+// includes
+// --------
+
+#include <cmath> // fabs
+
+#include "Graph.h"
+
+// The kernels run over CompressedGraph, whose rows are contiguous arrays, and split the
+// vertices into ranges with the same number of edges, so a thread that gets the hubs does
+// not get more work. The Graph overloads freeze their argument first.
+
+// --------------
+// edge_partition
+// --------------
+
+/**
+ * splits the vertices of g into contiguous ranges that hold about the same number of
+ * edges plus vertices
+ * @param g the graph
+ * @param parts the number of ranges
+ * @return returns parts + 1 nondecreasing boundaries from 0 to num_vertices(g)
+ */
+template <typename V>
+vector<std::size_t> edge_partition (const basic_compressed_graph<V>& g, unsigned parts) {
+    parts = max(parts, 1u);
+    const std::size_t n = num_vertices(g);
+    vector<std::size_t> b(parts + 1, 0);
+    b[parts] = n;
+    if (n == 0)
+        return b;
+    const V* const base = adjacent_vertices(0, g).first;
+    const std::size_t total = num_edges(g) + n;
+    for (unsigned k = 1; k < parts; ++k) {
+        // the first vertex whose row starts at or after k / parts of the work
+        const std::size_t want = total * k / parts;
+        std::size_t lo = b[k - 1];
+        std::size_t hi = n;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (std::size_t(adjacent_vertices(mid, g).first - base) + mid < want)
+                lo = mid + 1;
+            else
+                hi = mid;}
+        b[k] = lo;}
+    return b;}
+
+// ---------
+// transpose
+// ---------
+
+/**
+ * @param g the graph to reverse
+ * @return returns the graph with every edge (u, v) replaced by (v, u); rows stay sorted
+ */
+template <typename V>
+basic_compressed_graph<V> transpose (const basic_compressed_graph<V>& g) {
+    struct arrays {
+        vector<std::size_t> offsets;
+        vector<V>           targets;};
+    const std::size_t n = num_vertices(g);
+    shared_ptr<arrays> a = make_shared<arrays>();
+    a->offsets.assign(n + 1, 0);
+    a->targets.resize(num_edges(g));
+    for (std::size_t u = 0; u != n; ++u) {
+        const std::pair<const V*, const V*> p = adjacent_vertices(u, g);
+        for (const V* i = p.first; i != p.second; ++i)
+            ++a->offsets[*i + 1];}
+    partial_sum(a->offsets.begin(), a->offsets.end(), a->offsets.begin());
+    vector<std::size_t> next(a->offsets.begin(), a->offsets.end() - 1);
+    for (std::size_t u = 0; u != n; ++u) {
+        const std::pair<const V*, const V*> p = adjacent_vertices(u, g);
+        for (const V* i = p.first; i != p.second; ++i)
+            a->targets[next[*i]++] = V(u);}
+    return basic_compressed_graph<V>(a, a->offsets.data(), a->targets.data(), n);}
+
+// ----------
+// row_gather
+// ----------
+
+/**
+ * @return returns the sum of x over the row [b, e), with four independent accumulators so
+ *         that the loads of the gather overlap instead of waiting on one running sum
+ */
+template <typename V, typename T>
+inline T row_gather (const V* b, const V* e, const T* x) {
+    T s0 = T(), s1 = T(), s2 = T(), s3 = T();
+    for (; e - b >= 4; b += 4) {
+        s0 += x[b[0]];
+        s1 += x[b[1]];
+        s2 += x[b[2]];
+        s3 += x[b[3]];}
+    for (; b != e; ++b)
+        s0 += x[*b];
+    return (s0 + s1) + (s2 + s3);}
+
+// ----
+// spmv
+// ----
+
+/**
+ * sparse matrix vector product with the adjacency matrix of g: y[v] = add over the row of v of x[u]
+ * @param g the graph; its rows are the rows of the matrix
+ * @param x the input vector, one value per vertex
+ * @param y returns the output vector, one value per vertex
+ * @param zero the identity of add
+ * @param add an associative operation; it is applied to the values of a row in order
+ * @param threads the number of threads, each given an edge balanced range of rows
+ */
+template <typename V, typename T, typename Add>
+void spmv (const basic_compressed_graph<V>& g, const vector<T>& x, vector<T>& y, T zero, Add add, unsigned threads = 1) {
+    const vector<std::size_t> b = edge_partition(g, threads);
+    y.resize(num_vertices(g));
+    parallel_for(b.size() - 1, b.size() - 1, [&] (std::size_t p, std::size_t q, unsigned) {
+        for (; p != q; ++p)
+            for (std::size_t v = b[p]; v != b[p + 1]; ++v) {
+                const std::pair<const V*, const V*> r = adjacent_vertices(v, g);
+                T s = zero;
+                for (const V* i = r.first; i != r.second; ++i)
+                    s = add(s, x[*i]);
+                y[v] = s;}});}
+
+/**
+ * the (+, *) product with unit edge weights, using the unrolled row_gather
+ */
+template <typename V, typename T>
+void spmv (const basic_compressed_graph<V>& g, const vector<T>& x, vector<T>& y, unsigned threads = 1) {
+    const vector<std::size_t> b = edge_partition(g, threads);
+    y.resize(num_vertices(g));
+    parallel_for(b.size() - 1, b.size() - 1, [&] (std::size_t p, std::size_t q, unsigned) {
+        for (; p != q; ++p)
+            for (std::size_t v = b[p]; v != b[p + 1]; ++v) {
+                const std::pair<const V*, const V*> r = adjacent_vertices(v, g);
+                y[v] = row_gather(r.first, r.second, x.data());}});}
+
+// ----------------
+// pagerank_options
+// ----------------
+
+/**
+ * parameters of pagerank and personalized_pagerank
+ */
+struct pagerank_options {
+    double   damping;        // probability of following an edge rather than teleporting
+    double   tolerance;      // stop once the L1 change of an iteration is below this
+    unsigned max_iterations;
+    unsigned threads;
+    bool     push;           // scatter along out edges instead of gathering along in edges
+
+    pagerank_options () :
+            damping(0.85),
+            tolerance(1e-9),
+            max_iterations(100),
+            threads(1),
+            push(false)
+        {}};
+
+// ----------------
+// pagerank_iterate
+// ----------------
+
+/**
+ * Power iteration with teleport vector p. The rank of a dangling vertex is spread along p.
+ * A pull iteration is one pass over the vertices. In the same loop it forms each new rank,
+ * the contribution rank / out_degree that the next iteration gathers, the dangling mass, the
+ * sum and the L1 change. The sum is not divided out in a pass of its own: the next iteration
+ * multiplies by it once per vertex instead.
+ * Pull mode gathers over the transpose of g. Push mode scatters over g into one shared
+ * array, of atomics when there is more than one thread, so its memory stays O(n) for any
+ * number of threads; the rank pass reads each sum and clears it for the next iteration.
+ * @param g the graph
+ * @param p the teleport distribution, which sums to 1
+ * @param rank returns the ranks, which sum to 1
+ * @param opt the parameters
+ * @return returns the number of iterations run
+ */
+template <typename V>
+unsigned pagerank_iterate (const basic_compressed_graph<V>& g, const vector<double>& p, vector<double>& rank, const pagerank_options& opt) {
+    const std::size_t n = num_vertices(g);
+    const unsigned    k = max(opt.threads, 1u);
+    const double      d = opt.damping;
+    rank = p;
+    if (n == 0)
+        return 0;
+
+    const basic_compressed_graph<V> t = opt.push ? basic_compressed_graph<V>() : transpose(g);
+    const vector<std::size_t> parts = edge_partition(opt.push ? g : t, k);
+    vector<double> inverse(n);
+    for (std::size_t u = 0; u != n; ++u) {
+        const std::pair<const V*, const V*> r = adjacent_vertices(u, g);
+        inverse[u] = (r.first == r.second) ? 0.0 : 1.0 / (r.second - r.first);}
+
+    // contrib and the dangling mass are kept unscaled; scale is applied to what is gathered
+    vector<double> contrib(n);
+    vector<double> following(n);
+    vector<double> next(n);
+    vector<double>                plain(opt.push && k == 1 ? n : 0);
+    vector< std::atomic<double> > sum(opt.push && k != 1 ? n : 0);
+    for (std::size_t v = 0; v != sum.size(); ++v)
+        sum[v].store(0.0, std::memory_order_relaxed);
+    vector<double> dangling(k);
+    vector<double> total(k);
+    vector<double> change(k);
+    double m     = 0;
+    double scale = 1.0;
+    for (std::size_t u = 0; u != n; ++u) {
+        contrib[u] = rank[u] * inverse[u];
+        m += (inverse[u] == 0.0) ? rank[u] : 0.0;}
+
+    const bool push = opt.push;
+    unsigned it = 0;
+    while (it < opt.max_iterations) {
+        if (push)
+            parallel_for(k, k, [&] (std::size_t c, std::size_t, unsigned) {
+                for (std::size_t u = parts[c]; u != parts[c + 1]; ++u) {
+                    const std::pair<const V*, const V*> r = adjacent_vertices(u, g);
+                    const double x = contrib[u];
+                    if (k == 1) {
+                        for (const V* i = r.first; i != r.second; ++i)
+                            plain[*i] += x;
+                        continue;}
+                    for (const V* i = r.first; i != r.second; ++i) {
+                        // there is no atomic fetch_add for double in C++11
+                        double y = sum[*i].load(std::memory_order_relaxed);
+                        while (!sum[*i].compare_exchange_weak(y, y + x, std::memory_order_relaxed))
+                            ;}}});
+
+        parallel_for(k, k, [&] (std::size_t c, std::size_t, unsigned) {
+            // in push mode any split of the vertices would do; the edge split is reused
+            double s     = 0;
+            double delta = 0;
+            double lost  = 0;
+            for (std::size_t v = parts[c]; v != parts[c + 1]; ++v) {
+                double in = 0;
+                if (push && k == 1) {
+                    in = plain[v];
+                    plain[v] = 0;}
+                else if (push)
+                    in = sum[v].exchange(0.0, std::memory_order_relaxed);
+                else {
+                    const std::pair<const V*, const V*> r = adjacent_vertices(v, t);
+                    in = row_gather(r.first, r.second, contrib.data());}
+                const double x = (1 - d) * p[v] + d * scale * (in + m * p[v]);
+                next[v]      = x;
+                following[v] = x * inverse[v];
+                s     += x;
+                lost  += (inverse[v] == 0.0) ? x : 0.0;
+                delta += std::fabs(x - rank[v] * scale);}
+            total[c]    = s;
+            dangling[c] = lost;
+            change[c]   = delta;});
+
+        ++it;
+        rank.swap(next);
+        contrib.swap(following);
+        m     = accumulate(dangling.begin(), dangling.end(), 0.0);
+        scale = 1.0 / accumulate(total.begin(), total.end(), 0.0);
+        if (accumulate(change.begin(), change.end(), 0.0) < opt.tolerance)
+            break;}
+
+    for (std::size_t v = 0; v != n; ++v)
+        rank[v] *= scale;
+    return it;}
+
+// --------
+// pagerank
+// --------
+
+/**
+ * @param g the graph
+ * @param rank returns the PageRank of every vertex; the ranks sum to 1
+ * @param opt the parameters
+ * @return returns the number of iterations run
+ */
+template <typename V>
+unsigned pagerank (const basic_compressed_graph<V>& g, vector<double>& rank, const pagerank_options& opt = pagerank_options()) {
+    const std::size_t n = num_vertices(g);
+    return pagerank_iterate(g, vector<double>(n, n == 0 ? 0.0 : 1.0 / n), rank, opt);}
+
+template <typename V, typename D, typename C>
+unsigned pagerank (const basic_graph<V, D, C>& g, vector<double>& rank, const pagerank_options& opt = pagerank_options()) {
+    return pagerank(freeze(g), rank, opt);}
+
+// ---------------------
+// personalized_pagerank
+// ---------------------
+
+/**
+ * PageRank that teleports only to the given sources, so rank measures closeness to them
+ * @param g the graph
+ * @param sources the vertices to teleport to, with equal weight; repeats add weight
+ * @param rank returns the rank of every vertex; the ranks sum to 1
+ * @param opt the parameters
+ * @return returns the number of iterations run
+ * @throws invalid_argument if sources is empty or holds a vertex outside g
+ */
+template <typename V>
+unsigned personalized_pagerank (const basic_compressed_graph<V>& g, const vector<V>& sources, vector<double>& rank, const pagerank_options& opt = pagerank_options()) {
+    if (sources.empty())
+        throw std::invalid_argument("personalized_pagerank: no sources");
+    vector<double> p(num_vertices(g), 0.0);
+    for (typename vector<V>::const_iterator i = sources.begin(); i != sources.end(); ++i) {
+        if ((std::size_t)*i >= p.size()) // a negative id converts to a value past any size
+            throw std::invalid_argument("personalized_pagerank: source is not a vertex");
+        p[*i] += 1.0 / sources.size();}
+    return pagerank_iterate(g, p, rank, opt);}
+
+template <typename V, typename D, typename C>
+unsigned personalized_pagerank (const basic_graph<V, D, C>& g, const vector<V>& sources, vector<double>& rank, const pagerank_options& opt = pagerank_options()) {
+    return personalized_pagerank(freeze(g), sources, rank, opt);}
+
+// ----------
+// symmetrize
+// ----------
+
+/**
+ * @param g the graph
+ * @param threads the number of threads merging rows
+ * @return returns the graph with an edge (v, u) next to every edge (u, v); rows stay sorted and unique
+ */
+template <typename V>
+basic_compressed_graph<V> symmetrize (const basic_compressed_graph<V>& g, unsigned threads = 1) {
+    struct arrays {
+        vector<std::size_t> offsets;
+        vector<V>           targets;};
+    const basic_compressed_graph<V> t = transpose(g);
+    const std::size_t n = num_vertices(g);
+    vector< vector<V> > rows(n);
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t u = b; u != e; ++u) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(u, g);
+            const std::pair<const V*, const V*> q = adjacent_vertices(u, t);
+            set_union(p.first, p.second, q.first, q.second, back_inserter(rows[u]));
+            rows[u].erase(unique(rows[u].begin(), rows[u].end()), rows[u].end());}});
+    shared_ptr<arrays> a = make_shared<arrays>();
+    a->offsets.reserve(n + 1);
+    a->offsets.push_back(0);
+    for (std::size_t u = 0; u != n; ++u) {
+        a->targets.insert(a->targets.end(), rows[u].begin(), rows[u].end());
+        a->offsets.push_back(a->targets.size());}
+    return basic_compressed_graph<V>(a, a->offsets.data(), a->targets.data(), n);}
+
+// ----------------
+// reorder_strategy
+// ----------------
+
+/**
+ * how reorder numbers the vertices
+ */
+enum reorder_strategy {
+    reorder_rcm,    // reverse Cuthill-McKee: small bandwidth, so neighbors get nearby ids
+    reorder_degree, // descending out degree: the hubs share the first cache lines
+    reorder_bfs};   // breadth first visit order, one component after another
+
+// ----------------
+// reorder_ordering
+// ----------------
+
+/**
+ * @param g the graph
+ * @param s the strategy
+ * @param threads the number of threads for symmetrize
+ * @return returns old_id: the old id of every vertex, listed in the new order
+ */
+template <typename V>
+vector<V> reorder_ordering (const basic_compressed_graph<V>& g, reorder_strategy s, unsigned threads) {
+    const std::size_t n = num_vertices(g);
+    vector<V> order;
+    order.reserve(n);
+    if (s == reorder_degree) {
+        // a stable counting sort on degree, largest first
+        std::size_t most = 0;
+        for (std::size_t u = 0; u != n; ++u)
+            most = max<std::size_t>(most, out_degree(u, g));
+        vector<std::size_t> start(most + 2, 0);
+        for (std::size_t u = 0; u != n; ++u)
+            ++start[most - out_degree(u, g) + 1];
+        partial_sum(start.begin(), start.end(), start.begin());
+        order.resize(n);
+        for (std::size_t u = 0; u != n; ++u)
+            order[start[most - out_degree(u, g)]++] = V(u);
+        return order;}
+
+    // BFS and RCM follow edges in both directions, so that a directed graph is not cut into
+    // singletons wherever edges point backwards
+    const basic_compressed_graph<V> h = symmetrize(g, threads);
+    vector<char> seen(n, 0);
+    vector<V> roots;
+    if (s == reorder_bfs)
+        for (std::size_t u = 0; u != n; ++u)
+            roots.push_back(V(u));
+    else {
+        // Cuthill-McKee starts each component at a vertex of least degree
+        roots = reorder_ordering(h, reorder_degree, threads);
+        reverse(roots.begin(), roots.end());}
+    vector<V> next;
+    for (typename vector<V>::const_iterator r = roots.begin(); r != roots.end(); ++r) {
+        if (seen[*r])
+            continue;
+        seen[*r] = 1;
+        std::size_t head = order.size();
+        order.push_back(*r);
+        while (head != order.size()) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(order[head++], h);
+            next.clear();
+            for (const V* i = p.first; i != p.second; ++i)
+                if (!seen[*i]) {
+                    seen[*i] = 1;
+                    next.push_back(*i);}
+            if (s == reorder_rcm)
+                stable_sort(next.begin(), next.end(), [&] (V a, V b) {return out_degree(a, h) < out_degree(b, h);});
+            order.insert(order.end(), next.begin(), next.end());}}
+    if (s == reorder_rcm)
+        reverse(order.begin(), order.end());
+    return order;}
+
+// ---------------
+// reordered_graph
+// ---------------
+
+/**
+ * what reorder returns: the relabeled graph and the permutation in both directions
+ */
+template <typename G>
+struct reordered_graph {
+    typedef typename G::vertex_descriptor vertex_descriptor;
+
+    G                         graph;
+    vector<vertex_descriptor> new_id; // new_id[old] is the id of old in graph
+    vector<vertex_descriptor> old_id; // old_id[v] is the id in the input of vertex v of graph
+};
+
+// -------
+// reorder
+// -------
+
+/**
+ * relabels the vertices of g for locality; the rows of the result are built in parallel
+ * @param g the graph
+ * @param s the strategy
+ * @param threads the number of threads
+ * @return returns the relabeled graph, new_id and old_id
+ */
+template <typename V>
+reordered_graph< basic_compressed_graph<V> > reorder (const basic_compressed_graph<V>& g, reorder_strategy s, unsigned threads = 1) {
+    struct arrays {
+        vector<std::size_t> offsets;
+        vector<V>           targets;};
+    const std::size_t n = num_vertices(g);
+    reordered_graph< basic_compressed_graph<V> > r;
+    r.old_id = reorder_ordering(g, s, threads);
+    r.new_id.resize(n);
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t v = b; v != e; ++v)
+            r.new_id[r.old_id[v]] = V(v);});
+
+    shared_ptr<arrays> a = make_shared<arrays>();
+    a->offsets.resize(n + 1);
+    a->offsets[0] = 0;
+    for (std::size_t v = 0; v != n; ++v)
+        a->offsets[v + 1] = a->offsets[v] + out_degree(r.old_id[v], g);
+    a->targets.resize(a->offsets[n]);
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t v = b; v != e; ++v) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(r.old_id[v], g);
+            const typename vector<V>::iterator out = a->targets.begin() + a->offsets[v];
+            for (const V* i = p.first; i != p.second; ++i)
+                out[i - p.first] = r.new_id[*i];
+            sort(out, out + (p.second - p.first));}});
+    r.graph = basic_compressed_graph<V>(a, a->offsets.data(), a->targets.data(), n);
+    return r;}
+
+/**
+ * relabels a Graph through its snapshot and rebuilds it with the bulk add_edges path
+ */
+template <typename V, typename D, typename C>
+reordered_graph< basic_graph<V, D, C> > reorder (const basic_graph<V, D, C>& g, reorder_strategy s, unsigned threads = 1) {
+    typedef typename basic_graph<V, D, C>::edge_descriptor edge_descriptor;
+    reordered_graph< basic_compressed_graph<V> > c = reorder(freeze(g), s, threads);
+    const std::size_t n = num_vertices(c.graph);
+    vector<edge_descriptor> v;
+    v.reserve(num_edges(c.graph));
+    for (std::size_t u = 0; u != n; ++u) {
+        const std::pair<const V*, const V*> p = adjacent_vertices(u, c.graph);
+        for (const V* i = p.first; i != p.second; ++i)
+            // a snapshot of an undirected graph holds both directions; keep one
+            if (D::is_directed || (std::size_t)*i >= u)
+                v.push_back(edge_descriptor(V(u), *i));}
+    reordered_graph< basic_graph<V, D, C> > r;
+    r.graph = basic_graph<V, D, C>(v.begin(), v.end(), threads);
+    while (num_vertices(r.graph) < n)
+        add_vertex(r.graph);
+    r.new_id.swap(c.new_id);
+    r.old_id.swap(c.old_id);
+    return r;}
+
+// ---------------
+// intersect_count
+// ---------------
+
+/**
+ * @return returns the number of values in both sorted ranges, by merging them
+ */
+template <typename I, typename J>
+std::size_t merge_count (I a, I ae, J b, J be) {
+    std::size_t c = 0;
+    while (a != ae && b != be) {
+        if (*a < *b)
+            ++a;
+        else if (*b < *a)
+            ++b;
+        else {
+            ++c;
+            ++a;
+            ++b;}}
+    return c;}
+
+/**
+ * @return returns the number of values in both sorted, unique rows; when one row is more
+ *         than 32 times longer, each value of the short row gallops through the long one
+ *         instead of merging, so a hub costs the degree of its neighbor, not its own
+ */
+template <typename V>
+std::size_t intersect_count (const V* a, const V* ae, const V* b, const V* be) {
+    if (ae - a > be - b) {
+        swap(a, b);
+        swap(ae, be);}
+    if (be - b <= 32 * (ae - a))
+        return merge_count(a, ae, b, be);
+    std::size_t c = 0;
+    for (; a != ae && b != be; ++a) {
+        // double the step until it passes *a, then binary search the last step
+        std::ptrdiff_t step = 1;
+        while (step < be - b && b[step] < *a)
+            step <<= 1;
+        b = lower_bound(b + step / 2, b + min<std::ptrdiff_t>(step + 1, be - b), *a);
+        if (b != be && *b == *a) {
+            ++c;
+            ++b;}}
+    return c;}
+
+// ------
+// orient
+// ------
+
+/**
+ * @param g a symmetric graph, as symmetrize returns
+ * @param threads the number of threads
+ * @return returns the acyclic graph that keeps an edge (u, v) only if u comes before v by
+ *         (degree, id); self loops are dropped and rows stay sorted. Every triangle of g is
+ *         in it once, and no row is longer than the square root of twice the edges.
+ */
+template <typename V>
+basic_compressed_graph<V> orient (const basic_compressed_graph<V>& g, unsigned threads = 1) {
+    struct arrays {
+        vector<std::size_t> offsets;
+        vector<V>           targets;};
+    const std::size_t n = num_vertices(g);
+    const auto before = [&] (std::size_t u, std::size_t v) {
+        const std::size_t du = out_degree(u, g);
+        const std::size_t dv = out_degree(v, g);
+        return du < dv || (du == dv && u < v);};
+    shared_ptr<arrays> a = make_shared<arrays>();
+    a->offsets.assign(n + 1, 0);
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t u = b; u != e; ++u) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(u, g);
+            for (const V* i = p.first; i != p.second; ++i)
+                a->offsets[u + 1] += before(u, *i);}});
+    partial_sum(a->offsets.begin(), a->offsets.end(), a->offsets.begin());
+    a->targets.resize(a->offsets[n]);
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t u = b; u != e; ++u) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(u, g);
+            typename vector<V>::iterator out = a->targets.begin() + a->offsets[u];
+            for (const V* i = p.first; i != p.second; ++i)
+                if (before(u, *i))
+                    *out++ = *i;}});
+    return basic_compressed_graph<V>(a, a->offsets.data(), a->targets.data(), n);}
+
+// ---------------
+// count_triangles
+// ---------------
+
+/**
+ * counts the triangles of the simple undirected graph under g: edge directions, self loops
+ * and parallel edges are ignored. Each triangle is found once, from its lowest vertex in the
+ * degree order of orient, and the vertices are handed out in small chunks as threads free up.
+ * @param g the graph
+ * @param threads the number of threads
+ * @return returns the number of triangles
+ */
+template <typename V>
+std::size_t count_triangles (const basic_compressed_graph<V>& g, unsigned threads = 1) {
+    const basic_compressed_graph<V> h = orient(symmetrize(g, threads), threads);
+    vector<std::size_t> count(max(threads, 1u), 0);
+    dynamic_for(num_vertices(h), threads, 64, [&] (std::size_t b, std::size_t e, unsigned t) {
+        std::size_t c = 0;
+        for (std::size_t u = b; u != e; ++u) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(u, h);
+            for (const V* i = p.first; i != p.second; ++i) {
+                const std::pair<const V*, const V*> q = adjacent_vertices(*i, h);
+                c += intersect_count(p.first, p.second, q.first, q.second);}}
+        count[t] += c;});
+    return accumulate(count.begin(), count.end(), std::size_t(0));}
+
+template <typename V, typename D, typename C>
+std::size_t count_triangles (const basic_graph<V, D, C>& g, unsigned threads = 1) {
+    return count_triangles(freeze(g), threads);}
+
+// ---------------
+// local_triangles
+// ---------------
+
+/**
+ * counts, for every vertex, the triangles of the simple undirected graph under g that it is in
+ * @param g the graph
+ * @param t returns the number of triangles at each vertex
+ * @param d if not 0, returns the degree of each vertex in the simple undirected graph
+ * @param threads the number of threads
+ */
+template <typename V>
+void local_triangles (const basic_compressed_graph<V>& g, vector<std::size_t>& t, vector<std::size_t>* d = 0, unsigned threads = 1) {
+    const basic_compressed_graph<V> h = symmetrize(g, threads);
+    const std::size_t n = num_vertices(h);
+    vector<char> loop(n);
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t u = b; u != e; ++u) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(u, h);
+            loop[u] = binary_search(p.first, p.second, V(u));}});
+    t.assign(n, 0);
+    if (d != 0)
+        d->assign(n, 0);
+    dynamic_for(n, threads, 64, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t u = b; u != e; ++u) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(u, h);
+            std::size_t c = 0;
+            for (const V* i = p.first; i != p.second; ++i) {
+                if ((std::size_t)*i == u)
+                    continue;
+                // u and *i are in both rows exactly when they have self loops
+                const std::pair<const V*, const V*> q = adjacent_vertices(*i, h);
+                c += intersect_count(p.first, p.second, q.first, q.second) - loop[u] - loop[*i];}
+            // every triangle at u was seen from both of its other corners
+            t[u] = c / 2;
+            if (d != 0)
+                (*d)[u] = (p.second - p.first) - loop[u];}});}
+
+// ----------------------
+// clustering_coefficient
+// ----------------------
+
+/**
+ * @param g the graph, read as a simple undirected graph
+ * @param c returns, for every vertex, the fraction of the pairs of its neighbors that are adjacent; 0 below two neighbors
+ * @param threads the number of threads
+ * @return returns the average of c over the vertices
+ */
+template <typename V>
+double clustering_coefficient (const basic_compressed_graph<V>& g, vector<double>& c, unsigned threads = 1) {
+    vector<std::size_t> t;
+    vector<std::size_t> d;
+    local_triangles(g, t, &d, threads);
+    c.assign(t.size(), 0.0);
+    double s = 0;
+    for (std::size_t u = 0; u != t.size(); ++u) {
+        if (d[u] >= 2)
+            c[u] = 2.0 * t[u] / (double(d[u]) * (d[u] - 1));
+        s += c[u];}
+    return t.empty() ? 0.0 : s / t.size();}
+
+template <typename V, typename D, typename C>
+double clustering_coefficient (const basic_graph<V, D, C>& g, vector<double>& c, unsigned threads = 1) {
+    return clustering_coefficient(freeze(g), c, threads);}
+
+// ----------------
+// common_neighbors
+// ----------------
+
+/**
+ * @param u a vertex
+ * @param v a vertex
+ * @param g the graph; the rows of u and v are intersected as they are, so pass a symmetrized graph to ignore directions
+ * @param out the output iterator that receives the common out neighbors in ascending order
+ * @return returns out past the last one written
+ */
+template <typename G, typename OI>
+OI common_neighbors (typename G::vertex_descriptor u, typename G::vertex_descriptor v, G& g, OI out) {
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    const std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(u, g);
+    const std::pair<adjacency_iterator, adjacency_iterator> q = adjacent_vertices(v, g);
+    return set_intersection(p.first, p.second, q.first, q.second, out);}
+
+/**
+ * @return returns the number of common out neighbors of u and v, galloping if one row is much longer
+ */
+template <typename V>
+std::size_t count_common_neighbors (V u, V v, const basic_compressed_graph<V>& g) {
+    const std::pair<const V*, const V*> p = adjacent_vertices(u, g);
+    const std::pair<const V*, const V*> q = adjacent_vertices(v, g);
+    return intersect_count(p.first, p.second, q.first, q.second);}
+
+template <typename V, typename D, typename C>
+std::size_t count_common_neighbors (V u, V v, basic_graph<V, D, C>& g) {
+    typedef typename basic_graph<V, D, C>::adjacency_iterator adjacency_iterator;
+    const std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(u, g);
+    const std::pair<adjacency_iterator, adjacency_iterator> q = adjacent_vertices(v, g);
+    return merge_count(p.first, p.second, q.first, q.second);}
+
+// ----------
+// union_find
+// ----------
+
+/**
+ * Lock-free disjoint sets over the vertices, after Shiloach-Vishkin: every set is a tree
+ * whose root is its smallest member, and link hangs the larger of two roots under the
+ * smaller with a compare and swap, so any number of threads may link at once.
+ */
+template <typename V>
+class union_find {
+    private:
+        vector< std::atomic<V> > _parent;
+
+    public:
+        /**
+         * makes n singletons
+         */
+        explicit union_find (std::size_t n, unsigned threads = 1) :
+                _parent(n) {
+            parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+                for (; b != e; ++b)
+                    _parent[b].store(V(b), std::memory_order_relaxed);});}
+
+        /**
+         * @return returns the parent of v, which is its root once compress has run
+         */
+        V parent (V v) const {
+            return _parent[v].load(std::memory_order_relaxed);}
+
+        /**
+         * merges the sets of u and v
+         */
+        void link (V u, V v) {
+            V p = parent(u);
+            V q = parent(v);
+            while (p != q) {
+                V high = max(p, q);
+                V low  = min(p, q);
+                V h    = parent(high);
+                // done if high already hangs under low, or if high was a root and now does
+                if (h == low || (h == high && _parent[high].compare_exchange_strong(h, low, std::memory_order_acq_rel)))
+                    return;
+                p = parent(parent(high));
+                q = parent(low);}}
+
+        /**
+         * points every vertex in [b, e) straight at its root; run it once no link is in flight
+         */
+        void compress (std::size_t b, std::size_t e) {
+            for (; b != e; ++b)
+                while (parent(V(b)) != parent(parent(V(b))))
+                    _parent[b].store(parent(parent(V(b))), std::memory_order_relaxed);}};
+
+// --------------------
+// connected_components
+// --------------------
+
+/**
+ * Weakly connected components with Afforest: link every vertex to its first two neighbors,
+ * find the component that a sample of 1024 vertices mostly falls in, then link the rest of
+ * the edges, where a vertex already in that component only links neighbors outside it.
+ * Edge directions are ignored and no transpose is built.
+ * @param g the graph
+ * @param c random access iterator (e.g. a pointer) that receives the component of each vertex;
+ *          components are numbered from 0 in the order of their smallest vertex, exactly as
+ *          boost::connected_components numbers them
+ * @param threads the number of threads
+ * @return returns the number of components
+ */
+template <typename V, typename RI>
+std::size_t connected_components (const basic_compressed_graph<V>& g, RI c, unsigned threads = 1) {
+    const std::size_t n     = num_vertices(g);
+    const std::size_t round = 2;
+    union_find<V> u(n, threads);
+    for (std::size_t r = 0; r != round; ++r)
+        parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+            for (; b != e; ++b) {
+                const std::pair<const V*, const V*> p = adjacent_vertices(b, g);
+                if (std::size_t(p.second - p.first) > r)
+                    u.link(V(b), p.first[r]);}});
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        u.compress(b, e);});
+
+    V big = 0;
+    if (n != 0) {
+        vector<V> sample;
+        for (std::size_t i = 0; i != min<std::size_t>(n, 1024); ++i)
+            sample.push_back(u.parent(V(i * n / min<std::size_t>(n, 1024))));
+        sort(sample.begin(), sample.end());
+        std::size_t most = 0;
+        for (std::size_t i = 0, j = 0; i != sample.size(); i = j) {
+            while (j != sample.size() && sample[j] == sample[i])
+                ++j;
+            if (j - i > most) {
+                most = j - i;
+                big  = sample[i];}}}
+
+    dynamic_for(n, threads, 256, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (; b != e; ++b) {
+            const std::pair<const V*, const V*> p = adjacent_vertices(b, g);
+            if (std::size_t(p.second - p.first) <= round)
+                continue;
+            // an undirected graph could skip these rows outright; a directed one may hold the
+            // only copy of an edge out of the big component, so its ends are still checked
+            const bool inside = (u.parent(V(b)) == big);
+            for (const V* i = p.first + round; i != p.second; ++i)
+                if (!inside || u.parent(*i) != big)
+                    u.link(V(b), *i);}});
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        u.compress(b, e);});
+
+    // every root is the smallest vertex of its component, so numbering the roots in order
+    // numbers the components the way a depth first search in vertex order discovers them
+    vector<std::size_t> label(n);
+    std::size_t k = 0;
+    for (std::size_t v = 0; v != n; ++v)
+        label[v] = (u.parent(V(v)) == V(v)) ? k++ : label[u.parent(V(v))];
+    parallel_for(n, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (; b != e; ++b)
+            c[b] = label[b];});
+    return k;}
+
+template <typename V, typename D, typename C, typename RI>
+std::size_t connected_components (basic_graph<V, D, C>& g, RI c, unsigned threads = 1) {
+    return connected_components(freeze(g), c, threads);}
+
+// -----------------
+// strong_components
+// -----------------
+
+/**
+ * Tarjan's algorithm with an explicit stack, visiting vertices in vertices order and
+ * neighbors in adjacency order, so deep graphs cannot overflow the call stack.
+ * @param g Graph or CompressedGraph
+ * @param c random access iterator that receives the component of each vertex; components are
+ *          numbered in the order their roots finish, exactly as boost::strong_components numbers them
+ * @return returns the number of strongly connected components
+ */
+template <typename G, typename RI>
+std::size_t tarjan_components (G& g, RI c) {
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef std::pair<adjacency_iterator, adjacency_iterator> range;
+
+    const std::size_t n    = num_vertices(g);
+    const std::size_t none = std::size_t(-1);
+    vector<std::size_t> index(n, none);
+    vector<std::size_t> low(n);
+    vector<std::size_t> component(n, none);
+    vector< std::pair<vertex_descriptor, range> > stack;
+    vector<vertex_descriptor> open; // visited vertices that are not yet in a component
+    std::size_t time = 0;
+    std::size_t k    = 0;
+    for (std::size_t s = 0; s != n; ++s) {
+        if (index[s] != none)
+            continue;
+        index[s] = low[s] = time++;
+        open.push_back(vertex_descriptor(s));
+        stack.push_back(std::make_pair(vertex_descriptor(s), adjacent_vertices(s, g)));
+        while (!stack.empty()) {
+            const vertex_descriptor u = stack.back().first;
+            range& r = stack.back().second;
+            if (r.first != r.second) {
+                const vertex_descriptor w = *r.first;
+                ++r.first;
+                if (index[w] == none) {
+                    index[w] = low[w] = time++;
+                    open.push_back(w);
+                    stack.push_back(std::make_pair(w, adjacent_vertices(w, g)));}
+                else if (component[w] == none)
+                    low[u] = min(low[u], index[w]);
+                continue;}
+            stack.pop_back();
+            if (!stack.empty())
+                low[stack.back().first] = min(low[stack.back().first], low[u]);
+            if (low[u] != index[u])
+                continue;
+            vertex_descriptor w;
+            do {
+                w = open.back();
+                open.pop_back();
+                component[w] = k;}
+            while (w != u);
+            ++k;}}
+    for (std::size_t v = 0; v != n; ++v)
+        c[v] = component[v];
+    return k;}
+
+/**
+ * @param g the graph
+ * @param c random access iterator that receives the strongly connected component of each vertex, numbered as boost::strong_components does
+ * @return returns the number of strongly connected components
+ */
+template <typename V, typename D, typename C, typename RI>
+std::size_t strong_components (basic_graph<V, D, C>& g, RI c) {
+    return tarjan_components(g, c);}
+
+/**
+ * @param g the graph
+ * @param c random access iterator that receives the strongly connected component of each vertex, numbered as boost::strong_components does
+ * @return returns the number of strongly connected components
+ */
+template <typename V, typename RI>
+std::size_t strong_components (const basic_compressed_graph<V>& g, RI c) {
+    return tarjan_components(g, c);}
+
+#endif // GraphAlgorithms_h
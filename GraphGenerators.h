@@ -0,0 +1,249 @@
+// --------------------------------
+// projects/graph/GraphGenerators.h
+// --------------------------------
+
+#ifndef GraphGenerators_h
+#define GraphGenerators_h
+
+// --------
+// includes
+// --------
+
+#include <cmath>     // floor, log
+#include <stdexcept> // invalid_argument
+#include <stdint.h>  // uint64_t
+
+#include "Graph.h"
+
+// Every generator draws its random numbers from counter_random(seed, stream, counter),
+// where stream and counter name the edge or row being generated, never the thread.
+// The output is therefore the same for any number of threads. Edges are generated into
+// a buffer in parallel and loaded with the bulk add_edges path, never with add_edge.
+
+// --------------
+// counter_random
+// --------------
+
+/**
+ * a counter based generator: the splitmix64 finalizer over a mix of its three arguments
+ * @return returns 64 random bits that depend only on seed, stream and counter
+ */
+inline uint64_t counter_random (uint64_t seed, uint64_t stream, uint64_t counter) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (stream + 1) + 0xD1B54A32D192ED03ULL * (counter + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = (z ^ (z >> 31)) * 0x9E3779B97F4A7C15ULL;
+    return z ^ (z >> 29);}
+
+/**
+ * @return returns a double in [0, 1) from the top 53 bits of counter_random
+ */
+inline double counter_uniform (uint64_t seed, uint64_t stream, uint64_t counter) {
+    return (counter_random(seed, stream, counter) >> 11) * (1.0 / 9007199254740992.0);}
+
+/**
+ * draws a uniform value below n without modulo bias: a draw in the incomplete top copy of
+ * [0, n) is rejected and redrawn from counter + 2^32, counter + 2 * 2^32, ...
+ * @param n the bound, above 0
+ * @return returns a value in [0, n) that depends only on seed, stream, counter and n
+ */
+inline uint64_t counter_below (uint64_t seed, uint64_t stream, uint64_t counter, uint64_t n) {
+    // 2^64 mod n: the draws below it are the ones that would favor small values
+    const uint64_t reject = (0 - n) % n;
+    for (uint64_t j = 0; ; ++j) {
+        const uint64_t r = counter_random(seed, stream, counter + (j << 32));
+        if (r >= reject)
+            return r % n;}}
+
+// ---------------
+// generated_graph
+// ---------------
+
+/**
+ * loads a generated edge list into a G with at least n vertices
+ */
+template <typename G>
+G generated_graph (const vector<typename G::edge_descriptor>& v, typename G::vertices_size_type n, unsigned threads) {
+    G g(v.begin(), v.end(), threads);
+    while (num_vertices(g) < n)
+        add_vertex(g);
+    return g;}
+
+// -----------
+// rmat_params
+// -----------
+
+/**
+ * quadrant probabilities of R-MAT; d is 1 - a - b - c. The defaults are Graph500's.
+ */
+struct rmat_params {
+    double a;
+    double b;
+    double c;
+    bool   scramble; // relabel vertices with a fixed bijection so that ids do not reveal degree
+
+    rmat_params () :
+            a(0.57),
+            b(0.19),
+            c(0.19),
+            scramble(true)
+        {}};
+
+// ----------
+// rmat_graph
+// ----------
+
+/**
+ * R-MAT / Kronecker graph on 2^scale vertices. Edge i picks one quadrant per level from
+ * its own counter stream; duplicate edges collapse as add_edges merges them.
+ * @param scale log2 of the number of vertices
+ * @param m the number of edges to draw; Graph500 uses 16 << scale
+ * @param seed the random seed
+ * @param threads the number of threads
+ * @param p quadrant probabilities
+ * @return returns the generated graph
+ */
+template <typename G>
+G rmat_graph (unsigned scale, uint64_t m, uint64_t seed, unsigned threads = 1, const rmat_params& p = rmat_params()) {
+    typedef typename G::vertex_descriptor vertex_descriptor;
+    typedef typename G::edge_descriptor   edge_descriptor;
+    const uint64_t n    = uint64_t(1) << scale;
+    const uint64_t mask = n - 1;
+    vector<edge_descriptor> v(m);
+    parallel_for(m, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t i = b; i != e; ++i) {
+            uint64_t s = 0;
+            uint64_t t = 0;
+            for (unsigned l = 0; l != scale; ++l) {
+                const double r = counter_uniform(seed, i, l);
+                const uint64_t bit = uint64_t(1) << (scale - 1 - l);
+                if (r >= p.a + p.b + p.c)
+                    s |= bit, t |= bit;
+                else if (r >= p.a + p.b)
+                    s |= bit;
+                else if (r >= p.a)
+                    t |= bit;}
+            if (p.scramble) {
+                // odd multiplier then xor-shift: both are bijections on [0, 2^scale)
+                s = (s * 0x9E3779B97F4A7C15ULL) & mask;
+                t = (t * 0x9E3779B97F4A7C15ULL) & mask;
+                s ^= s >> (scale / 2 + 1);
+                t ^= t >> (scale / 2 + 1);}
+            v[i] = edge_descriptor(vertex_descriptor(s), vertex_descriptor(t));}});
+    return generated_graph<G>(v, n, threads);}
+
+// ---------------
+// erdos_renyi_gnp
+// ---------------
+
+/**
+ * G(n, p): every ordered pair (u, w) is an edge with probability p; for undirected graphs
+ * every unordered pair {u, w}, drawn as u <= w so that it gets one chance. Row u is drawn
+ * from stream u by geometric skipping (Batagelj and Brandes), so the work is O(n + m).
+ * @param n the number of vertices
+ * @param p the edge probability
+ * @param seed the random seed
+ * @param threads the number of threads
+ * @return returns the generated graph
+ */
+template <typename G>
+G erdos_renyi_gnp (uint64_t n, double p, uint64_t seed, unsigned threads = 1) {
+    typedef typename G::vertex_descriptor vertex_descriptor;
+    typedef typename G::edge_descriptor   edge_descriptor;
+    const unsigned k = max(threads, 1u);
+    vector< vector<edge_descriptor> > parts(k);
+    parallel_for(n, k, [&] (std::size_t b, std::size_t e, unsigned c) {
+        for (std::size_t u = b; u != e; ++u) {
+            const uint64_t first = G::directed_category::is_directed ? 0 : u;
+            if (p >= 1.0) {
+                for (uint64_t w = first; w != n; ++w)
+                    parts[c].push_back(edge_descriptor(vertex_descriptor(u), vertex_descriptor(w)));
+                continue;}
+            if (p <= 0.0)
+                continue;
+            const double lq = std::log(1.0 - p);
+            double w = double(first) - 1;
+            for (uint64_t j = 0; ; ++j) {
+                w += 1 + std::floor(std::log(1.0 - counter_uniform(seed, u, j)) / lq);
+                if (w >= n)
+                    break;
+                parts[c].push_back(edge_descriptor(vertex_descriptor(u), vertex_descriptor(w)));}}});
+    vector<edge_descriptor> v;
+    for (unsigned c = 0; c != k; ++c)
+        v.insert(v.end(), parts[c].begin(), parts[c].end());
+    return generated_graph<G>(v, n, threads);}
+
+// ---------------
+// erdos_renyi_gnm
+// ---------------
+
+/**
+ * G(n, m): exactly m distinct edges with uniform endpoints. Candidate i comes from stream i;
+ * rounds of fresh candidates replace the duplicates until m distinct edges exist.
+ * @param n the number of vertices
+ * @param m the number of edges, at most n * n (n * (n + 1) / 2 for undirected graphs)
+ * @param seed the random seed
+ * @param threads the number of threads
+ * @return returns the generated graph
+ * @throws invalid_argument if m is above the number of possible edges
+ */
+template <typename G>
+G erdos_renyi_gnm (uint64_t n, uint64_t m, uint64_t seed, unsigned threads = 1) {
+    typedef typename G::vertex_descriptor vertex_descriptor;
+    typedef typename G::edge_descriptor   edge_descriptor;
+    // n * n, or n * (n + 1) / 2, compared without overflow
+    const bool fits = G::directed_category::is_directed ?
+        (n == 0 ? m == 0 : (m / n < n || (m / n == n && m % n == 0))) :
+        (n >= (uint64_t(1) << 32) || m <= n * (n + 1) / 2);
+    if (!fits)
+        throw std::invalid_argument("erdos_renyi_gnm: m is above the number of possible edges");
+    G g;
+    while (num_vertices(g) < n)
+        add_vertex(g);
+    uint64_t next = 0;
+    while (num_edges(g) < m) {
+        const uint64_t want = m - num_edges(g);
+        vector<edge_descriptor> v(want);
+        parallel_for(want, threads, [&] (std::size_t b, std::size_t e, unsigned) {
+            for (std::size_t i = b; i != e; ++i) {
+                v[i] = edge_descriptor(vertex_descriptor(counter_below(seed, next + i, 0, n)), vertex_descriptor(counter_below(seed, next + i, 1, n)));}});
+        next += want;
+        add_edges(v.begin(), v.end(), g, threads);}
+    return g;}
+
+// ----------
+// grid_graph
+// ----------
+
+/**
+ * 2D grid: vertex r * cols + c is joined to its right and lower neighbors in both directions
+ * (once each, for undirected graphs)
+ * @param rows the number of rows
+ * @param cols the number of columns
+ * @param threads the number of threads
+ * @return returns the generated graph
+ */
+template <typename G>
+G grid_graph (uint64_t rows, uint64_t cols, unsigned threads = 1) {
+    typedef typename G::vertex_descriptor vertex_descriptor;
+    typedef typename G::edge_descriptor   edge_descriptor;
+    const bool both = G::directed_category::is_directed;
+    const unsigned k = max(threads, 1u);
+    vector< vector<edge_descriptor> > parts(k);
+    parallel_for(rows * cols, k, [&] (std::size_t b, std::size_t e, unsigned c) {
+        for (std::size_t x = b; x != e; ++x) {
+            const vertex_descriptor u = vertex_descriptor(x);
+            if (x % cols + 1 < cols) {
+                parts[c].push_back(edge_descriptor(u, vertex_descriptor(x + 1)));
+                if (both)
+                    parts[c].push_back(edge_descriptor(vertex_descriptor(x + 1), u));}
+            if (x / cols + 1 < rows) {
+                parts[c].push_back(edge_descriptor(u, vertex_descriptor(x + cols)));
+                if (both)
+                    parts[c].push_back(edge_descriptor(vertex_descriptor(x + cols), u));}}});
+    vector<edge_descriptor> v;
+    for (unsigned c = 0; c != k; ++c)
+        v.insert(v.end(), parts[c].begin(), parts[c].end());
+    return generated_graph<G>(v, rows * cols, threads);}
+
+#endif // GraphGenerators_h
@@ -0,0 +1,355 @@
+// ------------------------
+// projects/graph/GraphIO.h
+// ------------------------
+
+#ifndef GraphIO_h
+#define GraphIO_h
+
+// --------
+// includes
+// --------
+
+#include <chrono>     // steady_clock
+#include <climits>    // INT_MAX
+#include <cstring>    // memchr, memcmp, memcpy, memmove
+#include <fstream>    // ifstream, ofstream
+#include <functional> // function
+#include <stdexcept>  // runtime_error
+#include <string>     // string
+#include <stdint.h>   // uint32_t, uint64_t
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+#include "Graph.h"
+
+// -----------------
+// graph_file_header
+// -----------------
+
+/**
+ * Layout of a saved graph, version 1:
+ *     graph_file_header
+ *     num_vertices + 1 offsets (CompressedGraph::edges_size_type)
+ *     num_edges targets        (CompressedGraph::vertex_descriptor)
+ * num_edges counts the stored targets, so an undirected graph, which stores each edge
+ * other than a self loop in both rows, saves 2m - loops of them.
+ * The arrays are exactly the ones CompressedGraph reads, so a mapped file is used in place.
+ */
+struct graph_file_header {
+    char     magic[8];     // "CSRGRAPH"
+    uint32_t version;
+    uint32_t endian;       // graph_file_endian as written by the saving machine
+    uint32_t offset_bytes; // sizeof(CompressedGraph::edges_size_type)
+    uint32_t vertex_bytes; // sizeof(CompressedGraph::vertex_descriptor)
+    uint64_t num_vertices;
+    uint64_t num_edges;
+    uint64_t checksum;     // FNV-1a of the offsets and targets arrays
+};
+
+const char     graph_file_magic[8]  = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t graph_file_version   = 1;
+const uint32_t graph_file_endian    = 0x01020304;
+const uint64_t graph_file_fnv_basis = 14695981039346656037ULL;
+
+// -------------
+// graph_fnv1a
+// -------------
+
+/**
+ * @param h the running hash
+ * @param p the bytes to fold into the hash
+ * @param n the number of bytes
+ * @return returns the FNV-1a hash of h followed by the n bytes at p
+ */
+inline uint64_t graph_fnv1a (uint64_t h, const void* p, std::size_t n) {
+    const unsigned char* b = static_cast<const unsigned char*>(p);
+    for (std::size_t i = 0; i != n; ++i) {
+        h ^= b[i];
+        h *= 1099511628211ULL;}
+    return h;}
+
+// ----
+// save
+// ----
+
+/**
+ * writes g in the binary graph format; rows are streamed, so g is not copied
+ * @param g any graph with num_vertices and adjacent_vertices (Graph or CompressedGraph)
+ * @param path the file to create or overwrite
+ */
+template <typename G>
+void save (G& g, const std::string& path) {
+    typedef CompressedGraph::edges_size_type   offset_type;
+    typedef CompressedGraph::vertex_descriptor target_type;
+    typedef typename G::adjacency_iterator     adjacency_iterator;
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("save: cannot open " + path);
+
+    graph_file_header h;
+    std::memcpy(h.magic, graph_file_magic, sizeof(h.magic));
+    h.version      = graph_file_version;
+    h.endian       = graph_file_endian;
+    h.offset_bytes = sizeof(offset_type);
+    h.vertex_bytes = sizeof(target_type);
+    h.num_vertices = num_vertices(g);
+    h.num_edges    = 0; // the stored targets, known once the offsets are written
+    h.checksum     = 0;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    uint64_t cs = graph_file_fnv_basis;
+    offset_type o = 0;
+    out.write(reinterpret_cast<const char*>(&o), sizeof(o));
+    cs = graph_fnv1a(cs, &o, sizeof(o));
+    for (uint64_t v = 0; v != h.num_vertices; ++v) {
+        std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, g);
+        o += std::distance(p.first, p.second);
+        out.write(reinterpret_cast<const char*>(&o), sizeof(o));
+        cs = graph_fnv1a(cs, &o, sizeof(o));}
+    h.num_edges = o;
+
+    std::vector<target_type> row;
+    for (uint64_t v = 0; v != h.num_vertices; ++v) {
+        std::pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(v, g);
+        row.assign(p.first, p.second);
+        if (row.empty())
+            continue;
+        out.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(target_type));
+        cs = graph_fnv1a(cs, row.data(), row.size() * sizeof(target_type));}
+
+    h.checksum = cs;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    if (!out)
+        throw std::runtime_error("save: cannot write " + path);}
+
+// -----------
+// open_mapped
+// -----------
+
+/**
+ * maps a file written by save read-only and shared, so the pages are shared by every
+ * process that maps it; nothing is copied. The header sizes and the offsets are always
+ * checked (O(V)), so adjacent_vertices and edge stay inside the mapping; the targets are
+ * only checked with verify_checksum, which untrusted files need
+ * @param path the file to map
+ * @param verify_checksum if true, every byte of the arrays is read and checked against the header, and every target against num_vertices
+ * @return returns a CompressedGraph view backed by the mapping, unmapped when the last copy goes away
+ */
+inline CompressedGraph open_mapped (const std::string& path, bool verify_checksum = false) {
+    typedef CompressedGraph::edges_size_type   offset_type;
+    typedef CompressedGraph::vertex_descriptor target_type;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("open_mapped: cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(graph_file_header)) {
+        ::close(fd);
+        throw std::runtime_error("open_mapped: not a graph file " + path);}
+    const std::size_t length = st.st_size;
+    void* base = ::mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+        throw std::runtime_error("open_mapped: cannot map " + path);
+    shared_ptr<const void> storage(base, [length] (const void* p) {
+        ::munmap(const_cast<void*>(p), length);});
+
+    const graph_file_header& h = *static_cast<const graph_file_header*>(base);
+    if (std::memcmp(h.magic, graph_file_magic, sizeof(h.magic)) != 0 || h.version != graph_file_version)
+        throw std::runtime_error("open_mapped: not a graph file " + path);
+    if (h.endian != graph_file_endian || h.offset_bytes != sizeof(offset_type) || h.vertex_bytes != sizeof(target_type))
+        throw std::runtime_error("open_mapped: incompatible graph file " + path);
+    // sizes are checked by division, so a crafted header cannot wrap them around to length
+    const uint64_t payload = length - sizeof(h);
+    if (h.num_vertices >= payload / sizeof(offset_type))
+        throw std::runtime_error("open_mapped: truncated graph file " + path);
+    const uint64_t offsets_bytes = (h.num_vertices + 1) * sizeof(offset_type);
+    const uint64_t targets_bytes = payload - offsets_bytes;
+    if (targets_bytes % sizeof(target_type) != 0 || targets_bytes / sizeof(target_type) != h.num_edges)
+        throw std::runtime_error("open_mapped: truncated graph file " + path);
+
+    const char* p = static_cast<const char*>(base) + sizeof(h);
+    const offset_type* offsets = reinterpret_cast<const offset_type*>(p);
+    const target_type* targets = reinterpret_cast<const target_type*>(p + offsets_bytes);
+    if (offsets[0] != 0 || offsets[h.num_vertices] != h.num_edges)
+        throw std::runtime_error("open_mapped: corrupt graph file " + path);
+    for (uint64_t v = 0; v != h.num_vertices; ++v)
+        if (offsets[v] > offsets[v + 1])
+            throw std::runtime_error("open_mapped: corrupt graph file " + path);
+    if (verify_checksum) {
+        if (graph_fnv1a(graph_fnv1a(graph_file_fnv_basis, offsets, offsets_bytes), targets, targets_bytes) != h.checksum)
+            throw std::runtime_error("open_mapped: checksum mismatch in " + path);
+        for (uint64_t e = 0; e != h.num_edges; ++e)
+            if (targets[e] < 0 || (uint64_t)targets[e] >= h.num_vertices)
+                throw std::runtime_error("open_mapped: corrupt graph file " + path);}
+    return CompressedGraph(storage, offsets, targets, h.num_vertices);}
+
+// ------------------
+// parse_edge_lines
+// ------------------
+
+/**
+ * Scans whitespace separated "source target" lines (the SNAP edge list format) without
+ * iostreams. Blank lines and lines starting with '#' or '%' are skipped, as is anything
+ * after the second number on a line.
+ * @param b first character of a run of whole lines
+ * @param e one past the last character
+ * @param out the edges found are appended here
+ */
+inline void parse_edge_lines (const char* b, const char* e, vector<Graph::edge_descriptor>& out) {
+    while (b != e) {
+        const char c = *b;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            ++b;
+            continue;}
+        if (c == '#' || c == '%') {
+            const char* n = static_cast<const char*>(std::memchr(b, '\n', e - b));
+            b = (n == 0) ? e : n;
+            continue;}
+        long long v[2];
+        for (int k = 0; k != 2; ++k) {
+            while (b != e && (*b == ' ' || *b == '\t'))
+                ++b;
+            if (b == e || *b < '0' || *b > '9')
+                throw std::runtime_error("parse_edge_lines: expected a vertex id");
+            long long x = 0;
+            do {
+                x = x * 10 + (*b - '0');
+                if (x > INT_MAX)
+                    throw std::runtime_error("parse_edge_lines: vertex id out of range");
+                ++b;
+            } while (b != e && *b >= '0' && *b <= '9');
+            v[k] = x;}
+        out.push_back(Graph::edge_descriptor(v[0], v[1]));
+        while (b != e && *b != '\n')
+            ++b;}}
+
+// ------------------
+// edge_list_progress
+// ------------------
+
+/**
+ * reported to edge_list_options::progress after every window
+ */
+struct edge_list_progress {
+    uint64_t bytes;       // bytes parsed so far
+    uint64_t total_bytes; // size of the file
+    uint64_t edges;       // edges parsed so far, including duplicates
+    double   seconds;     // time since the load started
+};
+
+// -----------------
+// edge_list_options
+// -----------------
+
+struct edge_list_options {
+    unsigned     threads;      // parser threads per window
+    std::size_t  window_bytes; // bytes read per window; bounds the memory used for input
+    std::function<void (const edge_list_progress&)> progress;
+
+    edge_list_options () :
+            threads(1),
+            window_bytes(64 << 20),
+            progress()
+        {}};
+
+// ---------------------
+// for_each_edge_block
+// ---------------------
+
+/**
+ * Streams an edge list through a bounded window. Each window is cut at its last newline,
+ * split into one newline aligned chunk per thread, and parsed in parallel into per thread
+ * buffers, which are then handed to f one by one on the calling thread.
+ * @param path the edge list to read
+ * @param f called with each const vector<Graph::edge_descriptor>& buffer
+ * @param opt threads, window size and progress callback
+ * @return returns the number of edges parsed
+ */
+template <typename F>
+uint64_t for_each_edge_block (const std::string& path, F f, const edge_list_options& opt = edge_list_options()) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in)
+        throw std::runtime_error("for_each_edge_block: cannot open " + path);
+    in.seekg(0, std::ios::end);
+    edge_list_progress pr;
+    pr.bytes       = 0;
+    pr.total_bytes = in.tellg();
+    pr.edges       = 0;
+    pr.seconds     = 0;
+    in.seekg(0, std::ios::beg);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const unsigned threads = max(opt.threads, 1u);
+    vector<char> buffer(max<std::size_t>(opt.window_bytes, 1));
+    vector< vector<Graph::edge_descriptor> > parsed(threads);
+    std::size_t carry = 0;
+    bool eof = false;
+    while (!eof) {
+        if (carry == buffer.size())
+            buffer.resize(2 * buffer.size()); // a single line longer than the window
+        in.read(&buffer[carry], buffer.size() - carry);
+        const std::size_t filled = carry + in.gcount();
+        eof = !in;
+        const char* b = buffer.data();
+        std::size_t cut = filled;
+        if (!eof) {
+            while (cut != 0 && b[cut - 1] != '\n')
+                --cut;
+            if (cut == 0) {
+                carry = filled;
+                continue;}}
+
+        vector<const char*> bounds(threads + 1, b + cut);
+        bounds[0] = b;
+        for (unsigned t = 1; t < threads; ++t) {
+            const char* p = max(bounds[t - 1], b + cut * t / threads);
+            while (p != b + cut && p != b && p[-1] != '\n')
+                ++p;
+            bounds[t] = p;}
+        parallel_for(threads, threads, [&] (std::size_t i, std::size_t j, unsigned) {
+            for (; i != j; ++i) {
+                parsed[i].clear();
+                parse_edge_lines(bounds[i], bounds[i + 1], parsed[i]);}});
+        for (unsigned t = 0; t != threads; ++t) {
+            pr.edges += parsed[t].size();
+            f(static_cast<const vector<Graph::edge_descriptor>&>(parsed[t]));}
+
+        pr.bytes += cut;
+        pr.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (opt.progress)
+            opt.progress(pr);
+        carry = filled - cut;
+        std::memmove(buffer.data(), b + cut, carry);}
+    return pr.edges;}
+
+// --------------
+// load_edge_list
+// --------------
+
+/**
+ * parses an edge list into g with for_each_edge_block and add_edges; freeze g afterwards for a packed snapshot
+ * @param path the edge list to read
+ * @param g the graph to add the edges to
+ * @param opt threads, window size and progress callback
+ * @return returns the number of edges that were not already in g
+ */
+inline Graph::edges_size_type load_edge_list (const std::string& path, Graph& g, const edge_list_options& opt = edge_list_options()) {
+    // add_edges costs O(num_vertices) on top of the batch, so blocks are gathered until the
+    // batch is at least as large as the vertex set, which keeps the whole load O(V + E)
+    Graph::edges_size_type n = 0;
+    vector<Graph::edge_descriptor> batch;
+    for_each_edge_block(path, [&] (const vector<Graph::edge_descriptor>& v) {
+        batch.insert(batch.end(), v.begin(), v.end());
+        if (batch.size() >= num_vertices(g)) {
+            n += add_edges(batch.begin(), batch.end(), g, opt.threads);
+            batch.clear();}}, opt);
+    n += add_edges(batch.begin(), batch.end(), g, opt.threads);
+    return n;}
+
+#endif // GraphIO_h
@@ -0,0 +1,142 @@
+// ------------------------------
+// projects/graph/GraphMetrics.h
+// ------------------------------
+
+#ifndef GraphMetrics_h
+#define GraphMetrics_h
+
+// Compile-time hooks that count and time the hot Graph operations. Build with
+// -DGRAPH_INSTRUMENT to turn them on; without it GRAPH_PROBE and GRAPH_COUNT expand
+// to nothing, so an uninstrumented build pays nothing. The measurements go to the
+// graph_metrics_sink installed with set_graph_metrics_sink, by default a graph_counters.
+
+// --------
+// includes
+// --------
+
+#include <atomic>  // atomic
+#include <chrono>  // steady_clock
+#include <cstddef> // size_t
+#include <stdint.h> // uint64_t
+
+// --------
+// graph_op
+// --------
+
+/**
+ * the operations that are counted; add_edge_grow is the add_edge slow path that grows the vertex table,
+ * and adjacent_vertices and edges are counted but not timed, since they only build an iterator pair
+ */
+enum graph_op {
+    op_add_edge,
+    op_add_edge_grow,
+    op_edge,
+    op_adjacent_vertices,
+    op_edges,
+    graph_op_count};
+
+/**
+ * @return returns the name of op, for exporters
+ */
+inline const char* graph_op_name (graph_op op) {
+    static const char* const names[graph_op_count] = {"add_edge", "add_edge_grow", "edge", "adjacent_vertices", "edges"};
+    return names[op];}
+
+// ------------------
+// graph_metrics_sink
+// ------------------
+
+/**
+ * receives one call per instrumented operation; record may be called from many threads at once
+ */
+struct graph_metrics_sink {
+    virtual ~graph_metrics_sink () {}
+
+    /**
+     * @param op the operation
+     * @param nanoseconds how long it took, or 0 for an event that is only counted
+     */
+    virtual void record (graph_op op, uint64_t nanoseconds) = 0;};
+
+// --------------
+// graph_counters
+// --------------
+
+/**
+ * the default sink: a call count and a total time per operation, in relaxed atomics
+ */
+struct graph_counters : graph_metrics_sink {
+    std::atomic<uint64_t> calls[graph_op_count];
+    std::atomic<uint64_t> nanoseconds[graph_op_count];
+
+    graph_counters () {
+        reset();}
+
+    void record (graph_op op, uint64_t ns) {
+        calls[op].fetch_add(1, std::memory_order_relaxed);
+        nanoseconds[op].fetch_add(ns, std::memory_order_relaxed);}
+
+    void reset () {
+        for (int i = 0; i != graph_op_count; ++i) {
+            calls[i].store(0, std::memory_order_relaxed);
+            nanoseconds[i].store(0, std::memory_order_relaxed);}}};
+
+// ----------------------
+// set_graph_metrics_sink
+// ----------------------
+
+/**
+ * @return returns the sink that is installed until set_graph_metrics_sink replaces it
+ */
+inline graph_counters& graph_default_counters () {
+    static graph_counters c;
+    return c;}
+
+/**
+ * @return returns the process-wide slot that holds the installed sink
+ */
+inline std::atomic<graph_metrics_sink*>& graph_metrics_slot () {
+    static std::atomic<graph_metrics_sink*> s(&graph_default_counters());
+    return s;}
+
+/**
+ * installs s as the sink for every instrumented operation; s must outlive its use
+ * @return returns the sink it replaces
+ */
+inline graph_metrics_sink* set_graph_metrics_sink (graph_metrics_sink* s) {
+    return graph_metrics_slot().exchange(s);}
+
+// -----------
+// graph_probe
+// -----------
+
+/**
+ * times the scope it lives in and reports it to the installed sink on exit
+ */
+class graph_probe {
+    private:
+        graph_op                              _op;
+        std::chrono::steady_clock::time_point _start;
+
+    public:
+        explicit graph_probe (graph_op op) :
+                _op(op),
+                _start(std::chrono::steady_clock::now())
+            {}
+
+        ~graph_probe () {
+            const std::chrono::nanoseconds d = std::chrono::steady_clock::now() - _start;
+            graph_metrics_slot().load(std::memory_order_acquire)->record(_op, d.count());}
+
+        graph_probe (const graph_probe&) = delete;
+        graph_probe& operator = (const graph_probe&) = delete;};
+
+#ifdef GRAPH_INSTRUMENT
+    #define GRAPH_PROBE(op) graph_probe graph_probe_##op(op_##op)
+    #define GRAPH_COUNT(op) graph_metrics_slot().load(std::memory_order_acquire)->record(op_##op, 0)
+#else
+    #define GRAPH_PROBE(op)
+    #define GRAPH_COUNT(op)
+#endif
+
+#endif // GraphMetrics_h
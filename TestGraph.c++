@@ -58,10 +58,18 @@ To document the program:
 
 #include "boost/graph/adjacency_list.hpp"  // adjacency_list
 #include "boost/graph/topological_sort.hpp"// topological_sort
+#include "boost/graph/connected_components.hpp" // connected_components
+#include "boost/graph/strong_components.hpp"    // strong_components
 
 #include "gtest/gtest.h"
 
 #include "Graph.h"
+#include "GraphIO.h"
+#include "GraphGenerators.h"
+#include "ConcurrentGraph.h"
+#include "VersionedGraph.h"
+#include "EncodedGraph.h"
+#include "GraphAlgorithms.h"
 
 #include <vector>
 
@@ -104,7 +112,8 @@ struct TestGraph : testing::Test {
 // possibly cyclic
 typedef testing::Types<
             boost::adjacency_list<boost::setS, boost::vecS, boost::directedS>,
-            Graph>
+            Graph,
+            basic_graph<unsigned, directedS, setS> >
             my_types;
 
 TYPED_TEST_CASE(TestGraph, my_types);
@@ -884,4 +893,1706 @@ TYPED_TEST(TestGraph, Vertices_3) {
     ASSERT_EQ(e, b);
 }
 
+TYPED_TEST(TestGraph, Connected_Components_1) {
+    ALL_TYPEDEF
+
+    graph_type g;
+
+    for (int i = 0; i < 8; ++i)
+        add_vertex(g);
+    const int e[][2] = {{0, 3}, {3, 5}, {1, 2}, {6, 6}, {7, 1}};
+    for (int i = 0; i < 5; ++i) {
+        add_edge(e[i][0], e[i][1], g);
+        add_edge(e[i][1], e[i][0], g);}
+
+    vector<int> c(num_vertices(g));
+    ASSERT_EQ(4, connected_components(g, &c[0]));
+    const int expected[] = {0, 1, 1, 0, 2, 0, 3, 1};
+    ASSERT_TRUE(equal(c.begin(), c.end(), expected));
+}
+
+TYPED_TEST(TestGraph, Strong_Components_1) {
+    ALL_TYPEDEF
+
+    graph_type g;
+
+    const int e[][2] = {{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4}, {4, 3}, {5, 4}};
+    for (int i = 0; i < 7; ++i)
+        add_edge(e[i][0], e[i][1], g);
+
+    vector<int> c(num_vertices(g));
+    ASSERT_EQ(3, strong_components(g, &c[0]));
+    const int expected[] = {1, 1, 1, 0, 0, 2};
+    ASSERT_TRUE(equal(c.begin(), c.end(), expected));
+}
+
+
+
+
+// -----------------
+// TestFrozenGraph
+// -----------------
+
+// read-only graphs are built as a Graph and then converted with make()
+template <typename G>
+struct FrozenTraits;
+
+template <>
+struct FrozenTraits<Graph> {
+    static Graph make (const Graph& g) {
+        return g;}};
+
+template <>
+struct FrozenTraits<CompressedGraph> {
+    static CompressedGraph make (const Graph& g) {
+        return freeze(g);}};
+
+// a CompressedGraph that went through save and open_mapped
+struct MappedGraph : CompressedGraph {
+    MappedGraph (const CompressedGraph& g) :
+            CompressedGraph(g)
+        {}};
+
+template <>
+struct FrozenTraits<MappedGraph> {
+    static MappedGraph make (const Graph& g) {
+        Graph h = g;
+        save(h, "TestGraph.mapped.bin");
+        MappedGraph m = open_mapped("TestGraph.mapped.bin", true);
+        std::remove("TestGraph.mapped.bin");
+        return m;}};
+
+template <>
+struct FrozenTraits<GraphSnapshot> {
+    static GraphSnapshot make (const Graph& g) {
+        VersionedGraph h;
+        for (Graph::vertices_size_type i = 0; i != num_vertices(g); ++i)
+            add_vertex(h);
+        Graph c = g;
+        pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(c);
+        add_edges(p.first, p.second, h);
+        return snapshot(h);}};
+
+template <>
+struct FrozenTraits<EncodedGraph> {
+    static EncodedGraph make (const Graph& g) {
+        return encode(g);}};
+
+template <typename G>
+struct TestFrozenGraph : testing::Test {
+    // --------
+    // typedefs
+    // --------
+
+    typedef          G                     graph_type;
+    typedef typename G::vertex_descriptor  vertex_descriptor;
+    typedef typename G::edge_descriptor    edge_descriptor;
+    typedef typename G::vertex_iterator    vertex_iterator;
+    typedef typename G::edge_iterator      edge_iterator;
+    typedef typename G::adjacency_iterator adjacency_iterator;
+    typedef typename G::vertices_size_type vertices_size_type;
+    typedef typename G::edges_size_type    edges_size_type;
+
+    static G sample () {
+        Graph g;
+        add_edge(0, 1, g);
+        add_edge(0, 0, g);
+        add_edge(0, 2, g);
+        add_edge(1, 0, g);
+        add_edge(2, 1, g);
+        add_edge(5, 0, g);
+        return FrozenTraits<G>::make(g);}};
+
+typedef testing::Types<
+            Graph,
+            CompressedGraph,
+            MappedGraph,
+            GraphSnapshot,
+            EncodedGraph>
+            frozen_types;
+
+TYPED_TEST_CASE(TestFrozenGraph, frozen_types);
+
+TYPED_TEST(TestFrozenGraph, Empty_1) {
+    ALL_TYPEDEF
+
+    graph_type g = FrozenTraits<graph_type>::make(Graph());
+    ASSERT_EQ(0, num_vertices(g));
+    ASSERT_EQ(0, num_edges(g));
+    ASSERT_TRUE(vertices(g).first == vertices(g).second);
+    ASSERT_TRUE(edges(g).first == edges(g).second);
+}
+
+TYPED_TEST(TestFrozenGraph, Sizes_1) {
+    ALL_TYPEDEF
+
+    graph_type g = TestFixture::sample();
+    ASSERT_EQ(6, num_vertices(g));
+    ASSERT_EQ(6, num_edges(g));
+}
+
+TYPED_TEST(TestFrozenGraph, Adjacent_Vertices_1) {
+    ALL_TYPEDEF
+
+    graph_type g = TestFixture::sample();
+    pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(0, g);
+    vector<vertex_descriptor> v(p.first, p.second);
+    ASSERT_EQ(3, v.size());
+    ASSERT_EQ(0, v[0]);
+    ASSERT_EQ(1, v[1]);
+    ASSERT_EQ(2, v[2]);
+
+    p = adjacent_vertices(3, g);
+    ASSERT_TRUE(p.first == p.second);
+}
+
+TYPED_TEST(TestFrozenGraph, Edge_1) {
+    ALL_TYPEDEF
+
+    graph_type g = TestFixture::sample();
+    ASSERT_TRUE(edge(0, 2, g).second);
+    ASSERT_TRUE(edge(5, 0, g).second);
+    ASSERT_FALSE(edge(2, 0, g).second);
+    ASSERT_FALSE(edge(4, 4, g).second);
+    ASSERT_EQ(edge_descriptor(2, 1), edge(2, 1, g).first);
+}
+
+TYPED_TEST(TestFrozenGraph, Edges_1) {
+    ALL_TYPEDEF
+
+    graph_type g = TestFixture::sample();
+    pair<edge_iterator, edge_iterator> p = edges(g);
+    vector<edge_descriptor> v;
+    for (edge_iterator b = p.first; b != p.second; ++b)
+        v.push_back(*b);
+    ASSERT_EQ(6, v.size());
+    ASSERT_EQ(edge_descriptor(0, 0), v[0]);
+    ASSERT_EQ(edge_descriptor(0, 1), v[1]);
+    ASSERT_EQ(edge_descriptor(0, 2), v[2]);
+    ASSERT_EQ(edge_descriptor(1, 0), v[3]);
+    ASSERT_EQ(edge_descriptor(2, 1), v[4]);
+    ASSERT_EQ(edge_descriptor(5, 0), v[5]);
+}
+
+TYPED_TEST(TestFrozenGraph, Vertices_1) {
+    ALL_TYPEDEF
+
+    graph_type g = TestFixture::sample();
+    pair<vertex_iterator, vertex_iterator> p = vertices(g);
+    vertices_size_type n = 0;
+    for (vertex_iterator b = p.first; b != p.second; ++b, ++n)
+        ASSERT_EQ(vertex(n, g), *b);
+    ASSERT_EQ(num_vertices(g), n);
+}
+
+TYPED_TEST(TestGraph, Adjacent_Vertices_4) {
+    ALL_TYPEDEF
+
+    graph_type g;
+
+    for (int i = 0; i < 100; ++i)
+        add_vertex(g);
+    for (int i = 0; i < 100; ++i)
+        ASSERT_TRUE(add_edge(0, (i * 37) % 100, g).second);
+    ASSERT_FALSE(add_edge(0, 74, g).second);
+    ASSERT_EQ(100, num_edges(g));
+
+    pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(0, g);
+    vertex_descriptor expected = 0;
+    for (adjacency_iterator b = p.first; b != p.second; ++b, ++expected)
+        ASSERT_EQ(expected, *b);
+    ASSERT_EQ(100, expected);
+    ASSERT_TRUE(edge(0, 99, g).second);
+    ASSERT_FALSE(edge(99, 0, g).second);
+}
+
+TYPED_TEST(TestGraph, Remove_Edge_1) {
+    ALL_TYPEDEF
+
+    graph_type g;
+    add_edge(0, 1, g);
+    add_edge(0, 2, g);
+    add_edge(2, 2, g);
+    remove_edge(0, 1, g);
+    remove_edge(1, 0, g);
+    remove_edge(2, 2, g);
+    ASSERT_EQ(1, num_edges(g));
+    ASSERT_EQ(3, num_vertices(g));
+    ASSERT_FALSE(edge(0, 1, g).second);
+    ASSERT_TRUE(edge(0, 2, g).second);
+    ASSERT_FALSE(edge(2, 2, g).second);
+    ASSERT_TRUE(add_edge(0, 1, g).second);
+}
+
+TYPED_TEST(TestGraph, Clear_Vertex_1) {
+    ALL_TYPEDEF
+
+    graph_type g;
+    add_edge(0, 1, g);
+    add_edge(1, 1, g);
+    add_edge(1, 2, g);
+    add_edge(2, 1, g);
+    add_edge(2, 0, g);
+    clear_vertex(1, g);
+    ASSERT_EQ(3, num_vertices(g));
+    ASSERT_EQ(1, num_edges(g));
+    ASSERT_TRUE(edge(2, 0, g).second);
+    pair<adjacency_iterator, adjacency_iterator> p = adjacent_vertices(1, g);
+    ASSERT_TRUE(p.first == p.second);
+}
+
+// -------------
+// TestGraphBulk
+// -------------
+
+TEST(TestGraphBulk, Add_Edges_1) {
+    vector<Graph::edge_descriptor> v;
+    v.push_back(make_pair(2, 1));
+    v.push_back(make_pair(0, 3));
+    v.push_back(make_pair(0, 1));
+    v.push_back(make_pair(2, 1));
+    v.push_back(make_pair(0, 0));
+
+    Graph g;
+    ASSERT_EQ(4, add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(4, num_vertices(g));
+    ASSERT_EQ(4, num_edges(g));
+    ASSERT_TRUE(edge(0, 0, g).second);
+    ASSERT_TRUE(edge(2, 1, g).second);
+    ASSERT_FALSE(edge(1, 2, g).second);
+
+    pair<Graph::adjacency_iterator, Graph::adjacency_iterator> p = adjacent_vertices(0, g);
+    vector<Graph::vertex_descriptor> a(p.first, p.second);
+    ASSERT_EQ(3, a.size());
+    ASSERT_EQ(0, a[0]);
+    ASSERT_EQ(1, a[1]);
+    ASSERT_EQ(3, a[2]);
+}
+
+TEST(TestGraphBulk, Add_Edges_2) {
+    Graph g;
+    add_edge(0, 2, g);
+    add_edge(1, 1, g);
+
+    vector<Graph::edge_descriptor> v;
+    v.push_back(make_pair(0, 2));
+    v.push_back(make_pair(0, 1));
+    v.push_back(make_pair(1, 1));
+    ASSERT_EQ(1, add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(3, num_edges(g));
+    ASSERT_EQ(0, add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(3, num_edges(g));
+}
+
+TEST(TestGraphBulk, Add_Edges_3) {
+    vector<Graph::edge_descriptor> v;
+    Graph h;
+    for (int i = 0; i < 5000; ++i) {
+        Graph::edge_descriptor e((i * 7919) % 1000, (i * 104729) % 1000);
+        v.push_back(e);
+        add_edge(e.first, e.second, h);}
+
+    Graph g(v.begin(), v.end(), 4);
+    ASSERT_EQ(num_vertices(h), num_vertices(g));
+    ASSERT_EQ(num_edges(h), num_edges(g));
+    pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    pair<Graph::edge_iterator, Graph::edge_iterator> q = edges(h);
+    ASSERT_TRUE(equal(p.first, p.second, q.first));
+}
+
+// -----------
+// TestGraphIO
+// -----------
+
+TEST(TestGraphIO, Save_1) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(3, 2, g);
+    CompressedGraph c = freeze(g);
+    save(c, "TestGraph.io.bin");
+    CompressedGraph m = open_mapped("TestGraph.io.bin");
+    std::remove("TestGraph.io.bin");
+    ASSERT_EQ(4, num_vertices(m));
+    ASSERT_EQ(2, num_edges(m));
+    ASSERT_TRUE(edge(3, 2, m).second);
+    ASSERT_FALSE(edge(2, 3, m).second);
+}
+
+TEST(TestGraphIO, Save_2) {
+    basic_graph<int, undirectedS, setS> g;
+    add_edge(0, 1, g);
+    add_edge(2, 1, g);
+    add_edge(2, 2, g);
+    save(g, "TestGraph.io.bin");
+    CompressedGraph m = open_mapped("TestGraph.io.bin", true);
+    std::remove("TestGraph.io.bin");
+    ASSERT_EQ(3, num_vertices(m));
+    ASSERT_EQ(5, num_edges(m));
+    ASSERT_TRUE(edge(1, 0, m).second);
+    ASSERT_TRUE(edge(1, 2, m).second);
+    ASSERT_TRUE(edge(2, 2, m).second);
+    ASSERT_FALSE(edge(0, 2, m).second);
+}
+
+TEST(TestGraphIO, Open_Mapped_1) {
+    ASSERT_THROW(open_mapped("TestGraph.missing.bin"), std::runtime_error);
+}
+
+TEST(TestGraphIO, Open_Mapped_2) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    save(g, "TestGraph.io.bin");
+    {
+    fstream f("TestGraph.io.bin", ios::in | ios::out | ios::binary);
+    f.seekp(-1, ios::end);
+    f.put(7);
+    }
+    ASSERT_NO_THROW(open_mapped("TestGraph.io.bin"));
+    ASSERT_THROW(open_mapped("TestGraph.io.bin", true), std::runtime_error);
+    std::remove("TestGraph.io.bin");
+}
+
+TEST(TestGraphIO, Open_Mapped_3) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    save(g, "TestGraph.io.bin");
+    {
+    // (num_vertices + 1) * 8 wraps around to the size of the real offsets
+    fstream f("TestGraph.io.bin", ios::in | ios::out | ios::binary);
+    const uint64_t n = (uint64_t(1) << 61) + 3;
+    f.seekp(offsetof(graph_file_header, num_vertices));
+    f.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    }
+    ASSERT_THROW(open_mapped("TestGraph.io.bin"), std::runtime_error);
+
+    save(g, "TestGraph.io.bin");
+    {
+    // offsets 0, 2, 1, 2: the row of 1 would end before it starts
+    fstream f("TestGraph.io.bin", ios::in | ios::out | ios::binary);
+    const CompressedGraph::edges_size_type o[] = {2, 1};
+    f.seekp(sizeof(graph_file_header) + sizeof(o[0]));
+    f.write(reinterpret_cast<const char*>(o), sizeof(o));
+    }
+    ASSERT_THROW(open_mapped("TestGraph.io.bin"), std::runtime_error);
+    std::remove("TestGraph.io.bin");
+}
+
+TEST(TestGraphIO, Load_Edge_List_1) {
+    {
+    ofstream f("TestGraph.edges.txt");
+    f << "# Directed graph\n# FromNodeId\tToNodeId\n0\t1\r\n0 2\n\n2\t0\n  7   3  \n% comment\n0\t1\n3\t3";
+    }
+    Graph g;
+    ASSERT_EQ(5, load_edge_list("TestGraph.edges.txt", g));
+    ASSERT_EQ(8, num_vertices(g));
+    ASSERT_EQ(5, num_edges(g));
+    ASSERT_TRUE(edge(0, 2, g).second);
+    ASSERT_TRUE(edge(7, 3, g).second);
+    ASSERT_TRUE(edge(3, 3, g).second);
+    std::remove("TestGraph.edges.txt");
+}
+
+TEST(TestGraphIO, Load_Edge_List_2) {
+    {
+    ofstream f("TestGraph.edges.txt");
+    f << "# generated\n";
+    for (int i = 0; i < 1000; ++i)
+        f << (i * 7919) % 300 << '\t' << (i * 104729) % 300 << '\n';
+    }
+    Graph g;
+    load_edge_list("TestGraph.edges.txt", g);
+
+    edge_list_options opt;
+    opt.threads      = 3;
+    opt.window_bytes = 64;
+    uint64_t calls = 0;
+    edge_list_progress last;
+    opt.progress = [&] (const edge_list_progress& p) {
+        ++calls;
+        last = p;};
+    Graph h;
+    load_edge_list("TestGraph.edges.txt", h, opt);
+    std::remove("TestGraph.edges.txt");
+
+    ASSERT_LT(1, calls);
+    ASSERT_EQ(last.total_bytes, last.bytes);
+    ASSERT_EQ(1000, last.edges);
+    ASSERT_EQ(num_edges(g), num_edges(h));
+    pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    pair<Graph::edge_iterator, Graph::edge_iterator> q = edges(h);
+    ASSERT_TRUE(equal(p.first, p.second, q.first));
+}
+
+TEST(TestGraphIO, Load_Edge_List_3) {
+    {
+    ofstream f("TestGraph.edges.txt");
+    f << "0 1\n2 x\n";
+    }
+    Graph g;
+    ASSERT_THROW(load_edge_list("TestGraph.edges.txt", g), std::runtime_error);
+    std::remove("TestGraph.edges.txt");
+}
+
+TYPED_TEST(TestGraph, Topological_Sort_1) {
+    ALL_TYPEDEF
+
+    graph_type g;
+
+    for (int i = 0; i < 5; ++i)
+        add_vertex(g);
+    add_edge(0, 1, g);
+    add_edge(0, 2, g);
+    add_edge(1, 3, g);
+    add_edge(2, 3, g);
+    add_edge(4, 0, g);
+
+    vector<vertex_descriptor> v;
+    topological_sort(g, back_inserter(v));
+    ASSERT_EQ(5, v.size());
+    ASSERT_EQ(3, v[0]);
+    ASSERT_EQ(1, v[1]);
+    ASSERT_EQ(2, v[2]);
+    ASSERT_EQ(0, v[3]);
+    ASSERT_EQ(4, v[4]);
+}
+
+TYPED_TEST(TestGraph, Topological_Sort_2) {
+    ALL_TYPEDEF
+
+    graph_type g;
+
+    for (int i = 0; i < 4; ++i)
+        add_vertex(g);
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    add_edge(2, 0, g);
+
+    vector<vertex_descriptor> v;
+    ASSERT_THROW(topological_sort(g, back_inserter(v)), std::invalid_argument);
+}
+
+TYPED_TEST(TestGraph, Topological_Sort_3) {
+    ALL_TYPEDEF
+
+    graph_type g;
+
+    for (int i = 0; i < 300; ++i)
+        add_edge((i * 7) % 300, (i * 7 + 13) % 300 + 300, g);
+    for (int i = 0; i < 300; ++i)
+        add_edge(i + 300, (i * 11) % 300 + 600, g);
+
+    vector<vertex_descriptor> v;
+    topological_sort(g, back_inserter(v));
+    ASSERT_EQ(num_vertices(g), v.size());
+    vector<int> position(v.size());
+    for (unsigned i = 0; i < v.size(); ++i)
+        position[v[i]] = i;
+    pair<edge_iterator, edge_iterator> p = edges(g);
+    for (; p.first != p.second; ++p.first)
+        ASSERT_LT(position[target(*p.first, g)], position[source(*p.first, g)]);
+}
+
+// -----------------
+// TestGraphAcyclic
+// -----------------
+
+TEST(TestGraphAcyclic, Has_Cycle_1) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    ASSERT_FALSE(has_cycle(g));
+    ASSERT_FALSE(has_cycle(freeze(g)));
+    add_edge(2, 2, g);
+    ASSERT_TRUE(has_cycle(g));
+    ASSERT_TRUE(has_cycle(freeze(g)));
+}
+
+TEST(TestGraphAcyclic, Has_Cycle_2) {
+    vector<Graph::edge_descriptor> v;
+    for (int i = 0; i < 1000000; ++i)
+        v.push_back(make_pair(i, i + 1));
+    Graph g(v.begin(), v.end());
+    ASSERT_FALSE(has_cycle(g));
+    add_edge(1000000, 0, g);
+    ASSERT_TRUE(has_cycle(g));
+}
+
+TEST(TestGraphAcyclic, Parallel_Topological_Sort_1) {
+    vector<Graph::edge_descriptor> v;
+    for (int i = 0; i < 20000; ++i) {
+        v.push_back(make_pair(i % 5000, 5000 + (i * 7919) % 5000));
+        v.push_back(make_pair(5000 + i % 5000, 10000 + (i * 104729) % 5000));}
+    Graph g(v.begin(), v.end());
+
+    vector<Graph::vertex_descriptor> o;
+    parallel_topological_sort(g, back_inserter(o), 4, 16);
+    ASSERT_EQ(num_vertices(g), o.size());
+    vector<int> position(o.size());
+    for (unsigned i = 0; i < o.size(); ++i)
+        position[o[i]] = i;
+    for (unsigned i = 0; i < v.size(); ++i)
+        ASSERT_LT(position[v[i].second], position[v[i].first]);
+}
+
+TEST(TestGraphAcyclic, Parallel_Topological_Sort_2) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    add_edge(2, 1, g);
+    const CompressedGraph c = freeze(g);
+    vector<Graph::vertex_descriptor> o;
+    ASSERT_THROW(parallel_topological_sort(c, back_inserter(o), 2), not_a_dag);
+}
+
+// ----------------
+// TestGraphPolicy
+// ----------------
 
+TEST(TestGraphPolicy, Undirected_1) {
+    typedef basic_graph<unsigned, undirectedS> graph_type;
+    graph_type g;
+    ASSERT_TRUE(add_edge(2, 0, g).second);
+    ASSERT_FALSE(add_edge(0, 2, g).second);
+    ASSERT_TRUE(add_edge(1, 1, g).second);
+    ASSERT_TRUE(add_edge(1, 2, g).second);
+    ASSERT_EQ(3, num_vertices(g));
+    ASSERT_EQ(3, num_edges(g));
+    ASSERT_TRUE(edge(0, 2, g).second);
+    ASSERT_TRUE(edge(2, 1, g).second);
+
+    pair<graph_type::adjacency_iterator, graph_type::adjacency_iterator> a = adjacent_vertices(2, g);
+    vector<unsigned> v(a.first, a.second);
+    ASSERT_EQ(2, v.size());
+    ASSERT_EQ(0, v[0]);
+    ASSERT_EQ(1, v[1]);
+
+    pair<graph_type::edge_iterator, graph_type::edge_iterator> p = edges(g);
+    vector<graph_type::edge_descriptor> e;
+    for (; p.first != p.second; ++p.first)
+        e.push_back(*p.first);
+    ASSERT_EQ(3, e.size());
+    ASSERT_EQ(graph_type::edge_descriptor(0, 2), e[0]);
+    ASSERT_EQ(graph_type::edge_descriptor(1, 1), e[1]);
+    ASSERT_EQ(graph_type::edge_descriptor(1, 2), e[2]);
+}
+
+TEST(TestGraphPolicy, Undirected_2) {
+    typedef basic_graph<int, undirectedS> graph_type;
+    vector<graph_type::edge_descriptor> v;
+    v.push_back(make_pair(0, 1));
+    v.push_back(make_pair(1, 0));
+    v.push_back(make_pair(3, 3));
+    v.push_back(make_pair(3, 1));
+    graph_type g;
+    add_edge(1, 3, g);
+    ASSERT_EQ(2, add_edges(v.begin(), v.end(), g, 2));
+    ASSERT_EQ(3, num_edges(g));
+    ASSERT_TRUE(edge(1, 0, g).second);
+    ASSERT_TRUE(edge(3, 3, g).second);
+
+    basic_compressed_graph<int> c = freeze(g);
+    ASSERT_EQ(5, num_edges(c));
+    ASSERT_TRUE(edge(3, 1, c).second);
+}
+
+TEST(TestGraphPolicy, Multiset_1) {
+    typedef basic_graph<int, directedS, multisetS> graph_type;
+    graph_type g;
+    ASSERT_TRUE(add_edge(0, 1, g).second);
+    ASSERT_TRUE(add_edge(0, 1, g).second);
+    vector<graph_type::edge_descriptor> v(3, make_pair(1, 0));
+    ASSERT_EQ(3, add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(5, num_edges(g));
+
+    pair<graph_type::edge_iterator, graph_type::edge_iterator> p = edges(g);
+    ASSERT_EQ(5, distance(p.first, p.second));
+}
+
+TEST(TestGraphPolicy, Vertex_Id_1) {
+    typedef basic_graph<uint64_t> graph_type;
+    graph_type g;
+    add_edge(0, 3, g);
+    add_edge(3, 1, g);
+    vector<uint64_t> o;
+    topological_sort(g, back_inserter(o));
+    ASSERT_EQ(4, o.size());
+    ASSERT_EQ(1, o[0]);
+    ASSERT_EQ(3, o[1]);
+    ASSERT_EQ(0, o[2]);
+    ASSERT_EQ(2, o[3]);
+
+    basic_compressed_graph<uint64_t> c = freeze(g);
+    ASSERT_EQ(4, num_vertices(c));
+    ASSERT_TRUE(edge(3, 1, c).second);
+    ASSERT_FALSE(edge(1, 3, c).second);
+    ASSERT_FALSE(has_cycle(c));
+}
+
+// ----------------------
+// TestBidirectionalGraph
+// ----------------------
+
+template <typename G>
+struct TestBidirectionalGraph : testing::Test {
+    typedef          G                         graph_type;
+    typedef typename G::vertex_descriptor      vertex_descriptor;
+    typedef typename G::in_edge_iterator       in_edge_iterator;
+    typedef typename G::inv_adjacency_iterator inv_adjacency_iterator;
+
+    static G sample () {
+        G g;
+        for (int i = 0; i < 5; ++i)
+            add_vertex(g);
+        add_edge(0, 2, g);
+        add_edge(3, 2, g);
+        add_edge(1, 2, g);
+        add_edge(2, 2, g);
+        add_edge(2, 4, g);
+        add_edge(3, 2, g);
+        return g;}};
+
+typedef testing::Types<
+            boost::adjacency_list<boost::setS, boost::vecS, boost::bidirectionalS>,
+            basic_graph<int, bidirectionalS>,
+            basic_graph<unsigned, bidirectionalS, setS> >
+            bidirectional_types;
+
+TYPED_TEST_CASE(TestBidirectionalGraph, bidirectional_types);
+
+TYPED_TEST(TestBidirectionalGraph, In_Degree_1) {
+    typedef typename TestFixture::graph_type graph_type;
+
+    graph_type g = TestFixture::sample();
+    ASSERT_EQ(0, in_degree(0, g));
+    ASSERT_EQ(4, in_degree(2, g));
+    ASSERT_EQ(1, in_degree(4, g));
+    ASSERT_EQ(2, out_degree(2, g));
+}
+
+TYPED_TEST(TestBidirectionalGraph, In_Edges_1) {
+    typedef typename TestFixture::graph_type       graph_type;
+    typedef typename TestFixture::in_edge_iterator in_edge_iterator;
+
+    graph_type g = TestFixture::sample();
+    pair<in_edge_iterator, in_edge_iterator> p = in_edges(2, g);
+    vector<int> v;
+    for (; p.first != p.second; ++p.first) {
+        ASSERT_EQ(2, target(*p.first, g));
+        v.push_back(source(*p.first, g));}
+    sort(v.begin(), v.end());
+    ASSERT_EQ(4, v.size());
+    ASSERT_EQ(0, v[0]);
+    ASSERT_EQ(1, v[1]);
+    ASSERT_EQ(2, v[2]);
+    ASSERT_EQ(3, v[3]);
+}
+
+TYPED_TEST(TestBidirectionalGraph, Inv_Adjacent_Vertices_1) {
+    typedef typename TestFixture::graph_type             graph_type;
+    typedef typename TestFixture::inv_adjacency_iterator inv_adjacency_iterator;
+
+    graph_type g = TestFixture::sample();
+    pair<inv_adjacency_iterator, inv_adjacency_iterator> p = inv_adjacent_vertices(4, g);
+    ASSERT_TRUE(p.first != p.second);
+    ASSERT_EQ(2, *p.first);
+    ++p.first;
+    ASSERT_TRUE(p.first == p.second);
+
+    p = inv_adjacent_vertices(1, g);
+    ASSERT_TRUE(p.first == p.second);
+}
+
+TYPED_TEST(TestBidirectionalGraph, Remove_1) {
+    typedef typename TestFixture::graph_type graph_type;
+
+    graph_type g = TestFixture::sample();
+    remove_edge(3, 2, g);
+    ASSERT_EQ(3, in_degree(2, g));
+    ASSERT_EQ(0, out_degree(3, g));
+
+    clear_vertex(2, g);
+    ASSERT_EQ(0, num_edges(g));
+    ASSERT_EQ(0, in_degree(4, g));
+    ASSERT_EQ(0, out_degree(0, g));
+
+    add_edge(0, 4, g);
+    add_edge(4, 3, g);
+    remove_vertex(1, g);
+    ASSERT_EQ(4, num_vertices(g));
+    ASSERT_EQ(1, in_degree(3, g));
+    ASSERT_EQ(1, in_degree(2, g));
+    ASSERT_EQ(0, in_degree(0, g));
+    ASSERT_EQ(1, out_degree(3, g));
+}
+
+TEST(TestBidirectionalGraph, Add_Edges_1) {
+    typedef basic_graph<int, bidirectionalS> graph_type;
+    vector<graph_type::edge_descriptor> v;
+    for (int i = 0; i < 2000; ++i)
+        v.push_back(make_pair((i * 7919) % 100, (i * 104729) % 100));
+    graph_type g;
+    add_edge(5, 7, g);
+    add_edges(v.begin(), v.end(), g, 3);
+
+    graph_type::edges_size_type total = 0;
+    for (int u = 0; u < 100; ++u) {
+        total += in_degree(u, g);
+        pair<graph_type::in_edge_iterator, graph_type::in_edge_iterator> p = in_edges(u, g);
+        for (; p.first != p.second; ++p.first)
+            ASSERT_TRUE(edge(source(*p.first, g), u, g).second);}
+    ASSERT_EQ(num_edges(g), total);
+}
+
+// -------------------
+// TestGraphEdgeRanges
+// -------------------
+
+TEST(TestGraphEdgeRanges, Edges_1) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(3000000, 2, g);
+    add_edge(3000000, 5, g);
+    add_vertex(g);
+
+    pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    vector<Graph::edge_descriptor> v;
+    for (Graph::edge_iterator b = p.first; b != p.second; ++b)
+        v.push_back(*b);
+    ASSERT_EQ(3, v.size());
+    ASSERT_EQ(Graph::edge_descriptor(3000000, 5), v[2]);
+
+    Graph::edge_iterator e = p.second;
+    for (int i = 2; i >= 0; --i) {
+        --e;
+        ASSERT_EQ(v[i], *e);}
+    ASSERT_TRUE(e == p.first);
+}
+
+TEST(TestGraphEdgeRanges, Edges_2) {
+    typedef basic_graph<int, undirectedS> graph_type;
+    graph_type g;
+    add_edge(0, 1, g);
+    add_edge(2, 1, g);
+    add_edge(2, 2, g);
+
+    pair<graph_type::edge_iterator, graph_type::edge_iterator> p = edges(g);
+    graph_type::edge_iterator e = p.second;
+    --e;
+    ASSERT_EQ(graph_type::edge_descriptor(2, 2), *e);
+    e--;
+    ASSERT_EQ(graph_type::edge_descriptor(1, 2), *e);
+    --e;
+    ASSERT_EQ(graph_type::edge_descriptor(0, 1), *e);
+    ASSERT_TRUE(e == p.first);
+}
+
+TEST(TestGraphEdgeRanges, Edge_Ranges_1) {
+    vector<Graph::edge_descriptor> v;
+    for (int i = 0; i < 1000; ++i)
+        v.push_back(make_pair(0, i));
+    for (int i = 0; i < 3000; ++i)
+        v.push_back(make_pair(1 + (i * 7) % 2000, (i * 13) % 5000));
+    Graph g(v.begin(), v.end());
+
+    vector< pair<Graph::edge_iterator, Graph::edge_iterator> > r = edge_ranges(g, 4);
+    ASSERT_EQ(4, r.size());
+    ASSERT_TRUE(r.front().first == edges(g).first);
+    ASSERT_TRUE(r.back().second == edges(g).second);
+    Graph::edges_size_type total = 0;
+    for (unsigned k = 0; k < r.size(); ++k) {
+        if (k != 0) {
+            ASSERT_TRUE(r[k - 1].second == r[k].first);}
+        const Graph::edges_size_type n = distance(r[k].first, r[k].second);
+        ASSERT_LE(num_edges(g) / 4, n + 1);
+        total += n;}
+    ASSERT_EQ(num_edges(g), total);
+}
+
+TEST(TestGraphEdgeRanges, Parallel_For_Each_Edge_1) {
+    vector<Graph::edge_descriptor> v;
+    for (int i = 0; i < 5000; ++i)
+        v.push_back(make_pair((i * 7919) % 700, (i * 104729) % 700));
+    Graph g(v.begin(), v.end());
+    const CompressedGraph c = freeze(g);
+
+    long long expected = 0;
+    pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    for (; p.first != p.second; ++p.first)
+        expected += (*p.first).first * 1000LL + (*p.first).second;
+
+    std::atomic<long long> sum(0);
+    parallel_for_each_edge(g, [&sum] (Graph::edge_descriptor e) {sum += e.first * 1000LL + e.second;}, 4);
+    ASSERT_EQ(expected, sum.load());
+
+    sum = 0;
+    parallel_for_each_edge(c, [&sum] (CompressedGraph::edge_descriptor e) {sum += e.first * 1000LL + e.second;}, 3);
+    ASSERT_EQ(expected, sum.load());
+}
+
+// -------------------
+// TestGraphGenerators
+// -------------------
+
+TEST(TestGraphGenerators, Rmat_1) {
+    Graph g = rmat_graph<Graph>(10, 16 << 10, 42, 1);
+    Graph h = rmat_graph<Graph>(10, 16 << 10, 42, 4);
+    ASSERT_EQ(1024, num_vertices(g));
+    ASSERT_LT(8 << 10, num_edges(g));
+    ASSERT_GE(16 << 10, num_edges(g));
+    ASSERT_EQ(num_edges(g), num_edges(h));
+    pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    pair<Graph::edge_iterator, Graph::edge_iterator> q = edges(h);
+    ASSERT_TRUE(equal(p.first, p.second, q.first));
+
+    Graph d = rmat_graph<Graph>(10, 16 << 10, 43, 2);
+    ASSERT_NE(num_edges(g), num_edges(d));
+}
+
+TEST(TestGraphGenerators, Gnp_1) {
+    Graph g = erdos_renyi_gnp<Graph>(2000, 0.005, 7, 1);
+    Graph h = erdos_renyi_gnp<Graph>(2000, 0.005, 7, 3);
+    ASSERT_EQ(2000, num_vertices(g));
+    ASSERT_LT(16000, num_edges(g));
+    ASSERT_GT(24000, num_edges(g));
+    pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    pair<Graph::edge_iterator, Graph::edge_iterator> q = edges(h);
+    ASSERT_EQ(num_edges(g), num_edges(h));
+    ASSERT_TRUE(equal(p.first, p.second, q.first));
+
+    ASSERT_EQ(0, num_edges(erdos_renyi_gnp<Graph>(10, 0.0, 7)));
+    ASSERT_EQ(100, num_edges(erdos_renyi_gnp<Graph>(10, 1.0, 7)));
+}
+
+TEST(TestGraphGenerators, Gnp_2) {
+    // each unordered pair gets one chance: about p * n * (n + 1) / 2 = 10005 edges, not twice that
+    typedef basic_graph<int, undirectedS> undirected_graph;
+    undirected_graph g = erdos_renyi_gnp<undirected_graph>(2000, 0.005, 7, 2);
+    ASSERT_LT(8000, num_edges(g));
+    ASSERT_GT(12000, num_edges(g));
+    ASSERT_EQ(55, num_edges(erdos_renyi_gnp<undirected_graph>(10, 1.0, 7)));
+}
+
+TEST(TestGraphGenerators, Gnm_1) {
+    Graph g = erdos_renyi_gnm<Graph>(100, 5000, 11, 1);
+    Graph h = erdos_renyi_gnm<Graph>(100, 5000, 11, 4);
+    ASSERT_EQ(100, num_vertices(g));
+    ASSERT_EQ(5000, num_edges(g));
+    pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+    pair<Graph::edge_iterator, Graph::edge_iterator> q = edges(h);
+    ASSERT_TRUE(equal(p.first, p.second, q.first));
+}
+
+TEST(TestGraphGenerators, Gnm_2) {
+    ASSERT_EQ(100, num_edges(erdos_renyi_gnm<Graph>(10, 100, 3)));
+    ASSERT_THROW(erdos_renyi_gnm<Graph>(10, 101, 3), std::invalid_argument);
+    typedef basic_graph<int, undirectedS> undirected_graph;
+    ASSERT_EQ(55, num_edges(erdos_renyi_gnm<undirected_graph>(10, 55, 3)));
+    ASSERT_THROW(erdos_renyi_gnm<undirected_graph>(10, 56, 3), std::invalid_argument);
+    ASSERT_THROW(erdos_renyi_gnm<Graph>(0, 1, 3), std::invalid_argument);
+}
+
+TEST(TestGraphGenerators, Counter_Below_1) {
+    // a bound just above 2^63 rejects almost half the draws; a modulo would favor the low half
+    const uint64_t n = (uint64_t(1) << 63) + 1;
+    int low = 0;
+    for (uint64_t i = 0; i != 4000; ++i) {
+        const uint64_t r = counter_below(5, i, 0, n);
+        ASSERT_GT(n, r);
+        low += (r < n / 2);}
+    ASSERT_LT(1800, low);
+    ASSERT_GT(2200, low);
+    ASSERT_EQ(0, counter_below(5, 0, 0, 1));
+}
+
+TEST(TestGraphGenerators, Grid_1) {
+    Graph g = grid_graph<Graph>(3, 4, 2);
+    ASSERT_EQ(12, num_vertices(g));
+    ASSERT_EQ(2 * (3 * 3 + 4 * 2), num_edges(g));
+    ASSERT_TRUE(edge(5, 6, g).second);
+    ASSERT_TRUE(edge(6, 5, g).second);
+    ASSERT_TRUE(edge(5, 9, g).second);
+    ASSERT_FALSE(edge(3, 4, g).second);
+
+    basic_graph<unsigned, undirectedS> u = grid_graph< basic_graph<unsigned, undirectedS> >(3, 4);
+    ASSERT_EQ(3 * 3 + 4 * 2, num_edges(u));
+}
+
+// -------------------
+// TestConcurrentGraph
+// -------------------
+
+TEST(TestConcurrentGraph, Add_1) {
+    ConcurrentGraph g(4);
+    ASSERT_EQ(0, num_vertices(g));
+    ASSERT_TRUE(add_edge(2, 5, g).second);
+    ASSERT_FALSE(add_edge(2, 5, g).second);
+    ASSERT_EQ(6, num_vertices(g));
+    ASSERT_EQ(1, num_edges(g));
+    ASSERT_EQ(6, add_vertex(g));
+    ASSERT_TRUE(edge(2, 5, g).second);
+    ASSERT_FALSE(edge(5, 2, g).second);
+    ASSERT_FALSE(edge(2, 9, g).second);
+    ASSERT_EQ(1, out_degree(2, g));
+}
+
+TEST(TestConcurrentGraph, Segments_1) {
+    ConcurrentGraph g;
+    ASSERT_TRUE(add_edge(5000, 1023, g).second);
+    ASSERT_TRUE(add_edge(1024, 5000, g).second);
+    ASSERT_TRUE(add_edge(0, 3071, g).second);
+    ASSERT_EQ(5001, num_vertices(g));
+    pair<ConcurrentGraph::adjacency_iterator, ConcurrentGraph::adjacency_iterator> p = adjacent_vertices(5000, g);
+    ASSERT_EQ(1, distance(p.first, p.second));
+    ASSERT_EQ(1023, *p.first);
+    ASSERT_TRUE(edge(1024, 5000, g).second);
+    ASSERT_TRUE(edge(0, 3071, g).second);
+}
+
+TEST(TestConcurrentGraph, Threads_1) {
+    const vector<Graph::edge_descriptor> v = [] () {
+        vector<Graph::edge_descriptor> v;
+        for (int i = 0; i != 20000; ++i)
+            v.push_back(Graph::edge_descriptor((i * 7919) % 3000, (i * 104729) % 3001));
+        return v;} ();
+    const Graph h(v.begin(), v.end());
+
+    ConcurrentGraph g(64);
+    vector<std::thread> w;
+    for (unsigned t = 0; t != 8; ++t)
+        w.push_back(std::thread([&, t] () {
+            for (std::size_t i = t; i < v.size(); i += 3) // every edge is added by two or three threads
+                add_edge(v[i].first, v[i].second, g);}));
+    for (unsigned t = 0; t != 8; ++t)
+        w[t].join();
+    ASSERT_EQ(num_vertices(h), num_vertices(g));
+    ASSERT_EQ(num_edges(h), num_edges(g));
+    const CompressedGraph c = freeze(g);
+    const CompressedGraph d = freeze(h);
+    pair<CompressedGraph::edge_iterator, CompressedGraph::edge_iterator> p = edges(c);
+    pair<CompressedGraph::edge_iterator, CompressedGraph::edge_iterator> q = edges(d);
+    ASSERT_TRUE(equal(p.first, p.second, q.first));
+}
+
+TEST(TestConcurrentGraph, Threads_2) {
+    ConcurrentGraph g;
+    vector<std::thread> w;
+    vector< vector<int> > ids(4);
+    for (unsigned t = 0; t != 4; ++t)
+        w.push_back(std::thread([&, t] () {
+            for (int i = 0; i != 1000; ++i) {
+                const int u = add_vertex(g);
+                ids[t].push_back(u);
+                int n = 0;
+                for_each_adjacent(u, g, [&] (int) {++n;});
+                assert(n == 0);}}));
+    for (unsigned t = 0; t != 4; ++t)
+        w[t].join();
+    vector<int> all;
+    for (unsigned t = 0; t != 4; ++t)
+        all.insert(all.end(), ids[t].begin(), ids[t].end());
+    sort(all.begin(), all.end());
+    ASSERT_EQ(4000, num_vertices(g));
+    ASSERT_EQ(all.end(), unique(all.begin(), all.end()));
+    ASSERT_EQ(3999, all.back());
+}
+
+TEST(TestConcurrentGraph, Undirected_1) {
+    basic_concurrent_graph<unsigned, undirectedS> g;
+    ASSERT_TRUE(add_edge(1, 3, g).second);
+    ASSERT_FALSE(add_edge(3, 1, g).second);
+    ASSERT_TRUE(add_edge(2, 2, g).second);
+    ASSERT_EQ(2, num_edges(g));
+    ASSERT_TRUE(edge(3, 1, g).second);
+    ASSERT_EQ(1, out_degree(3, g));
+
+    basic_concurrent_graph<int, bidirectionalS> b;
+    add_edge(1, 3, b);
+    add_edge(2, 3, b);
+    ASSERT_EQ(2, in_degree(3, b));
+    ASSERT_EQ(0, in_degree(1, b));
+    ASSERT_FALSE(edge(3, 1, b).second);
+}
+
+// ------------------
+// TestVersionedGraph
+// ------------------
+
+TEST(TestVersionedGraph, Snapshot_1) {
+    VersionedGraph g;
+    add_edge(0, 1, g);
+    add_edge(200, 3, g);
+    const GraphSnapshot s = snapshot(g);
+    ASSERT_TRUE(add_edge(0, 2, g).second);
+    ASSERT_FALSE(add_edge(0, 1, g).second);
+    add_edge(5000, 1, g);
+    const GraphSnapshot t = snapshot(g);
+
+    ASSERT_EQ(201, num_vertices(s));
+    ASSERT_EQ(2, num_edges(s));
+    ASSERT_EQ(1, out_degree(0, s));
+    ASSERT_FALSE(edge(0, 2, s).second);
+    ASSERT_EQ(5001, num_vertices(t));
+    ASSERT_EQ(4, num_edges(t));
+    ASSERT_EQ(2, out_degree(0, t));
+    ASSERT_TRUE(edge(5000, 1, t).second);
+
+    // the untouched row is shared, the written one was copied
+    ASSERT_EQ(adjacent_vertices(200, s).first, adjacent_vertices(200, t).first);
+    ASSERT_NE(adjacent_vertices(0, s).first, adjacent_vertices(0, t).first);
+}
+
+TEST(TestVersionedGraph, Snapshot_2) {
+    VersionedGraph g;
+    vector<Graph::edge_descriptor> v;
+    for (int i = 0; i != 3000; ++i)
+        v.push_back(Graph::edge_descriptor((i * 7919) % 700, (i * 104729) % 701));
+    const Graph h(v.begin(), v.end());
+    ASSERT_EQ(num_edges(h), add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(0, add_edges(v.begin(), v.end(), g));
+
+    const GraphSnapshot s = snapshot(g);
+    const CompressedGraph c = freeze(s);
+    const CompressedGraph d = freeze(h);
+    ASSERT_EQ(num_vertices(d), num_vertices(c));
+    pair<GraphSnapshot::edge_iterator, GraphSnapshot::edge_iterator> p = edges(s);
+    pair<CompressedGraph::edge_iterator, CompressedGraph::edge_iterator> q = edges(d);
+    ASSERT_EQ(num_edges(d), distance(p.first, p.second));
+    ASSERT_TRUE(equal(p.first, p.second, q.first));
+}
+
+TEST(TestVersionedGraph, Threads_2) {
+    VersionedGraph g;
+    add_edge(0, 0, g);
+    vector<Graph::edge_descriptor> v;
+    for (int i = 0; i != 400000; ++i)
+        v.push_back(Graph::edge_descriptor(i % 20000, 1 + i / 20000));
+    std::atomic<bool> started(false);
+    std::atomic<bool> done(false);
+    std::thread writer([&] () {
+        started = true;
+        add_edges(v.begin(), v.end(), g);
+        done = true;});
+    while (!started)
+        std::this_thread::yield();
+    // snapshots taken while the batch runs see all of it or none of it
+    int taken = 0;
+    while (!done) {
+        const GraphSnapshot s = snapshot(g);
+        ASSERT_TRUE(num_edges(s) == 1 || num_edges(s) == 400001);
+        ++taken;}
+    writer.join();
+    ASSERT_LT(0, taken);
+    const GraphSnapshot s = snapshot(g);
+    ASSERT_EQ(400001, num_edges(s));
+    ASSERT_EQ(21, out_degree(0, s));
+}
+
+TEST(TestVersionedGraph, Threads_1) {
+    VersionedGraph g;
+    std::atomic<bool> done(false);
+    std::atomic<int>  bad(0);
+    std::thread reader([&] () {
+        while (!done) {
+            const GraphSnapshot s = snapshot(g);
+            pair<GraphSnapshot::edge_iterator, GraphSnapshot::edge_iterator> p = edges(s);
+            if ((GraphSnapshot::edges_size_type)distance(p.first, p.second) != num_edges(s))
+                ++bad;}});
+    for (int i = 0; i != 20000; ++i)
+        add_edge((i * 7919) % 5000, (i * 104729) % 5001, g);
+    done = true;
+    reader.join();
+    ASSERT_EQ(0, bad);
+}
+
+TEST(TestVersionedGraph, Grow_1) {
+    basic_versioned_graph<uint64_t, directedS> g;
+    const uint64_t u = uint64_t(1) << 62;
+    const uint64_t w = std::numeric_limits<uint64_t>::max() - 1;
+    ASSERT_TRUE(add_edge(0, u, g).second);
+    ASSERT_TRUE(add_edge(w, 3, g).second);
+    ASSERT_EQ(w + 1, num_vertices(g));
+    const basic_graph_snapshot<uint64_t> s = snapshot(g);
+    ASSERT_TRUE(edge(0, u, s).second);
+    ASSERT_TRUE(edge(w, 3, s).second);
+    ASSERT_FALSE(edge(u, 0, s).second);
+    ASSERT_EQ(1, out_degree(w, s));
+}
+
+TEST(TestVersionedGraph, Undirected_1) {
+    basic_versioned_graph<unsigned, undirectedS> g;
+    ASSERT_TRUE(add_edge(1, 3, g).second);
+    ASSERT_FALSE(add_edge(3, 1, g).second);
+    vector< pair<unsigned, unsigned> > v;
+    v.push_back(make_pair(2u, 2u));
+    v.push_back(make_pair(3u, 1u));
+    v.push_back(make_pair(0u, 2u));
+    ASSERT_EQ(2, add_edges(v.begin(), v.end(), g));
+    ASSERT_EQ(3, num_edges(g));
+
+    const basic_graph_snapshot<unsigned> s = snapshot(g);
+    ASSERT_EQ(5, num_edges(s));
+    ASSERT_TRUE(edge(2, 0, s).second);
+    ASSERT_TRUE(edge(2, 2, s).second);
+}
+
+// --------------
+// TestGraphDelta
+// --------------
+
+TEST(TestGraphDelta, Apply_Delta_1) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(0, 2, g);
+    add_edge(3, 0, g);
+
+    GraphDelta d;
+    d.removed.push_back(make_pair(0, 1));
+    d.removed.push_back(make_pair(1, 0));
+    d.removed.push_back(make_pair(9, 9));
+    d.inserted.push_back(make_pair(0, 1));
+    d.inserted.push_back(make_pair(4, 4));
+    d.inserted.push_back(make_pair(0, 2));
+    ASSERT_EQ(make_pair(2ul, 1ul), apply_delta(d, g));
+    ASSERT_EQ(4, num_edges(g));
+    ASSERT_EQ(5, num_vertices(g));
+    ASSERT_TRUE(edge(0, 1, g).second);
+    ASSERT_TRUE(edge(4, 4, g).second);
+
+    ASSERT_EQ(3, remove_edges(d.inserted.begin(), d.inserted.end(), g));
+    ASSERT_EQ(1, num_edges(g));
+    ASSERT_FALSE(edge(0, 2, g).second);
+    ASSERT_TRUE(edge(3, 0, g).second);
+}
+
+// boost::adjacency_list<setS, vecS> invalidates its iterators in remove_vertex, so this
+// only runs on basic_graph
+template <typename G>
+void remove_vertex_1 () {
+    typedef typename G::edge_iterator edge_iterator;
+
+    G g;
+    add_edge(0, 1, g);
+    add_edge(0, 3, g);
+    add_edge(1, 2, g);
+    add_edge(3, 0, g);
+    add_edge(3, 3, g);
+    add_edge(3, 2, g);
+    remove_vertex(1, g);
+    ASSERT_EQ(3, num_vertices(g));
+    ASSERT_EQ(4, num_edges(g));
+    ASSERT_TRUE(edge(0, 2, g).second);
+    ASSERT_TRUE(edge(2, 0, g).second);
+    ASSERT_TRUE(edge(2, 2, g).second);
+    ASSERT_TRUE(edge(2, 1, g).second);
+    ASSERT_FALSE(edge(0, 1, g).second);
+
+    pair<edge_iterator, edge_iterator> q = edges(g);
+    ASSERT_EQ(4, distance(q.first, q.second));}
+
+TEST(TestGraphDelta, Remove_Vertex_1) {
+    remove_vertex_1<Graph>();
+    remove_vertex_1< basic_graph<unsigned, directedS, setS> >();
+    remove_vertex_1< basic_graph<int, bidirectionalS, multisetS> >();
+}
+
+TEST(TestGraphDelta, Remove_Edges_1) {
+    basic_graph<int, undirectedS, multisetS> g;
+    add_edge(0, 1, g);
+    add_edge(1, 0, g);
+    add_edge(1, 1, g);
+    add_edge(1, 2, g);
+    ASSERT_EQ(4, num_edges(g));
+
+    vector< pair<int, int> > v;
+    v.push_back(make_pair(1, 0));
+    v.push_back(make_pair(1, 1));
+    ASSERT_EQ(3, remove_edges(v.begin(), v.end(), g, 2));
+    ASSERT_EQ(1, num_edges(g));
+    ASSERT_FALSE(edge(0, 1, g).second);
+    ASSERT_TRUE(edge(2, 1, g).second);
+
+    remove_edge(2, 1, g);
+    ASSERT_EQ(0, num_edges(g));
+    ASSERT_FALSE(edge(1, 2, g).second);
+}
+
+// --------------
+// TestGraphStats
+// --------------
+
+TEST(TestGraphStats, Graph_Stats_1) {
+    Graph g;
+    for (int i = 0; i != 10; ++i)
+        add_edge(0, i, g);
+    add_edge(1, 2, g);
+    add_vertex(g);
+    const graph_statistics s = graph_stats(g);
+    ASSERT_EQ(11, s.vertices);
+    ASSERT_EQ(11, s.edges);
+    ASSERT_EQ(10, s.degree_max);
+    ASSERT_EQ(0, s.degree_p50);
+    ASSERT_EQ(10, s.degree_p99);
+    ASSERT_DOUBLE_EQ(9.0 / 11, s.empty_vertex_ratio);
+    ASSERT_EQ(5, s.degree_histogram.size());
+    ASSERT_EQ(9, s.degree_histogram[0]);
+    ASSERT_EQ(1, s.degree_histogram[1]);
+    ASSERT_EQ(1, s.degree_histogram[4]);
+    ASSERT_GE(s.row_bytes, 11 * sizeof(int));
+    ASSERT_GT(s.load_factor, 0.0);
+    ASSERT_LE(s.load_factor, 1.0);
+    ASSERT_EQ(sizeof(g) + s.vertex_table_bytes + s.row_bytes, s.total_bytes);
+
+    const graph_statistics c = graph_stats(freeze(g));
+    ASSERT_EQ(11 * sizeof(int), c.row_bytes);
+    ASSERT_EQ(12 * sizeof(std::size_t), c.vertex_table_bytes);
+    ASSERT_EQ(s.degree_histogram, c.degree_histogram);
+    ASSERT_DOUBLE_EQ(1.0, c.load_factor);
+
+    basic_graph<int, bidirectionalS, setS> b;
+    add_edge(0, 1, b);
+    const graph_statistics t = graph_stats(b);
+    ASSERT_EQ(t.row_bytes, t.in_row_bytes);
+    ASSERT_LT(sizeof(int), t.row_bytes);
+}
+
+// -------------------
+// TestGraphAlgorithms
+// -------------------
+
+// the iterator based loop that the kernels replace
+vector<double> reference_pagerank (Graph& g, double d, int iterations) {
+    const int n = num_vertices(g);
+    vector<double> r(n, 1.0 / n);
+    for (int it = 0; it != iterations; ++it) {
+        vector<double> x(n, 0.0);
+        double dangling = 0;
+        for (int u = 0; u != n; ++u) {
+            pair<Graph::adjacency_iterator, Graph::adjacency_iterator> p = adjacent_vertices(u, g);
+            const int k = distance(p.first, p.second);
+            if (k == 0)
+                dangling += r[u];
+            for (; p.first != p.second; ++p.first)
+                x[*p.first] += r[u] / k;}
+        for (int v = 0; v != n; ++v)
+            x[v] = (1 - d) / n + d * (x[v] + dangling / n);
+        r.swap(x);}
+    return r;}
+
+TEST(TestGraphAlgorithms, Edge_Partition_1) {
+    Graph g;
+    for (int i = 1; i != 100; ++i)
+        add_edge(0, i, g);
+    add_edge(99, 0, g);
+    const CompressedGraph c = freeze(g);
+    const vector<std::size_t> b = edge_partition(c, 4);
+    ASSERT_EQ(5, b.size());
+    ASSERT_EQ(0, b[0]);
+    ASSERT_EQ(1, b[1]); // the hub is a range of its own
+    ASSERT_EQ(100, b[4]);
+    ASSERT_TRUE(is_sorted(b.begin(), b.end()));
+
+    const CompressedGraph t = transpose(c);
+    ASSERT_EQ(num_edges(c), num_edges(t));
+    ASSERT_TRUE(edge(5, 0, t).second);
+    ASSERT_TRUE(edge(0, 99, t).second);
+    ASSERT_FALSE(edge(0, 5, t).second);
+}
+
+TEST(TestGraphAlgorithms, Spmv_1) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(0, 2, g);
+    add_edge(2, 0, g);
+    add_vertex(g);
+    const CompressedGraph c = freeze(g);
+    vector<int> x;
+    x.push_back(1);
+    x.push_back(10);
+    x.push_back(100);
+    x.push_back(1000);
+    vector<int> y;
+    spmv(c, x, y, 2);
+    ASSERT_EQ(4, y.size());
+    ASSERT_EQ(110, y[0]);
+    ASSERT_EQ(0, y[1]);
+    ASSERT_EQ(1, y[2]);
+    ASSERT_EQ(0, y[3]);
+
+    spmv(c, x, y, 0, [] (int a, int b) {return max(a, b);}, 3);
+    ASSERT_EQ(100, y[0]);
+    ASSERT_EQ(1, y[2]);
+}
+
+TEST(TestGraphAlgorithms, Pagerank_1) {
+    Graph g = rmat_graph<Graph>(10, 8 << 10, 5, 2);
+    const vector<double> r = reference_pagerank(g, 0.85, 30);
+
+    pagerank_options opt;
+    opt.tolerance      = 0;
+    opt.max_iterations = 30;
+    for (int mode = 0; mode != 4; ++mode) {
+        opt.push    = (mode % 2 == 1);
+        opt.threads = (mode < 2) ? 1 : 4;
+        vector<double> s;
+        ASSERT_EQ(30, pagerank(g, s, opt));
+        ASSERT_EQ(r.size(), s.size());
+        ASSERT_NEAR(1.0, accumulate(s.begin(), s.end(), 0.0), 1e-9);
+        for (std::size_t v = 0; v != r.size(); ++v)
+            ASSERT_NEAR(r[v], s[v], 1e-12);}
+}
+
+TEST(TestGraphAlgorithms, Pagerank_2) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(1, 2, g);
+    add_edge(2, 0, g);
+    add_edge(3, 0, g);
+    vector<double> r;
+    pagerank_options opt;
+    opt.tolerance = 1e-4;
+    const unsigned it = pagerank(g, r, opt);
+    ASSERT_LT(it, 100);
+    ASSERT_NEAR(0.15 / 4, r[3], 1e-9);
+    ASSERT_GT(r[0], r[1]);
+
+    vector<double> p;
+    personalized_pagerank(g, vector<int>(1, 1), p);
+    ASSERT_DOUBLE_EQ(0.0, p[3]);
+    ASSERT_NEAR(1.0, p[0] + p[1] + p[2], 1e-9);
+    ASSERT_GT(p[1], p[2]);
+    ASSERT_GT(p[2], p[0]);
+
+    ASSERT_THROW(personalized_pagerank(g, vector<int>(), p), std::invalid_argument);
+    ASSERT_THROW(personalized_pagerank(g, vector<int>(1, 4), p), std::invalid_argument);
+    ASSERT_THROW(personalized_pagerank(g, vector<int>(1, -1), p), std::invalid_argument);
+
+    basic_graph<unsigned, directedS, setS> u;
+    add_edge(0, 1, u);
+    personalized_pagerank(u, vector<unsigned>(1, 1), p);
+    ASSERT_EQ(2, p.size());
+    ASSERT_THROW(personalized_pagerank(u, vector<unsigned>(1, 2), p), std::invalid_argument);
+}
+
+TEST(TestGraphAlgorithms, Out_Degree_1) {
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(0, 2, g);
+    add_edge(2, 0, g);
+    const CompressedGraph c = freeze(g);
+    ASSERT_EQ(2, out_degree(0, c));
+    ASSERT_EQ(0, out_degree(1, c));
+
+    const CompressedGraph s = symmetrize(c);
+    ASSERT_EQ(4, num_edges(s));
+    ASSERT_TRUE(edge(1, 0, s).second);
+    ASSERT_EQ(2, out_degree(0, s));
+}
+
+// ----------------
+// TestGraphReorder
+// ----------------
+
+// the bandwidth of g: the longest distance between the ids of two neighbors
+int bandwidth (const CompressedGraph& g) {
+    int b = 0;
+    for (int u = 0; u != (int)num_vertices(g); ++u) {
+        pair<const int*, const int*> p = adjacent_vertices(u, g);
+        for (; p.first != p.second; ++p.first)
+            b = max(b, abs(*p.first - u));}
+    return b;}
+
+// a path 0 - 1 - ... - n-1 whose vertices are shuffled
+Graph shuffled_path (int n, vector<int>& label) {
+    label.resize(n);
+    for (int i = 0; i != n; ++i)
+        label[i] = (int)((i * 7919LL) % n);
+    Graph g;
+    for (int i = 0; i + 1 < n; ++i) {
+        add_edge(label[i], label[i + 1], g);
+        add_edge(label[i + 1], label[i], g);}
+    return g;}
+
+TEST(TestGraphReorder, Permutation_1) {
+    Graph g = rmat_graph<Graph>(9, 4 << 9, 3);
+    for (int s = 0; s != 3; ++s) {
+        reordered_graph<Graph> r = reorder(g, reorder_strategy(s), 3);
+        ASSERT_EQ(num_vertices(g), num_vertices(r.graph));
+        ASSERT_EQ(num_edges(g), num_edges(r.graph));
+        for (int v = 0; v != (int)num_vertices(g); ++v)
+            ASSERT_EQ(v, r.old_id[r.new_id[v]]);
+        pair<Graph::edge_iterator, Graph::edge_iterator> p = edges(g);
+        for (; p.first != p.second; ++p.first)
+            ASSERT_TRUE(edge(r.new_id[source(*p.first, g)], r.new_id[target(*p.first, g)], r.graph).second);}
+}
+
+TEST(TestGraphReorder, Degree_1) {
+    const CompressedGraph c = freeze(rmat_graph<Graph>(9, 4 << 9, 4));
+    reordered_graph<CompressedGraph> r = reorder(c, reorder_degree);
+    for (int v = 1; v != (int)num_vertices(r.graph); ++v)
+        ASSERT_GE(out_degree(v - 1, r.graph), out_degree(v, r.graph));
+}
+
+TEST(TestGraphReorder, Rcm_1) {
+    vector<int> label;
+    const CompressedGraph c = freeze(shuffled_path(1000, label));
+    ASSERT_LT(100, bandwidth(c));
+    reordered_graph<CompressedGraph> r = reorder(c, reorder_rcm, 2);
+    ASSERT_EQ(1, bandwidth(r.graph));
+    ASSERT_EQ(num_edges(c), num_edges(r.graph));
+
+    reordered_graph<CompressedGraph> b = reorder(c, reorder_bfs);
+    ASSERT_EQ(0, b.new_id[0]);
+    ASSERT_GE(2, bandwidth(b.graph));
+}
+
+TEST(TestGraphReorder, Undirected_1) {
+    basic_graph<int, undirectedS, multisetS> g;
+    add_edge(0, 3, g);
+    add_edge(3, 0, g);
+    add_edge(2, 2, g);
+    add_edge(1, 3, g);
+    reordered_graph< basic_graph<int, undirectedS, multisetS> > r = reorder(g, reorder_degree);
+    ASSERT_EQ(4, num_edges(r.graph));
+    ASSERT_EQ(0, r.new_id[3]);
+    ASSERT_EQ(3, r.old_id[0]);
+}
+
+// ----------------
+// TestEncodedGraph
+// ----------------
+
+TEST(TestEncodedGraph, Varint_1) {
+    const uint64_t x[] = {0, 1, 127, 128, 300, 16383, 16384, uint64_t(1) << 35, ~uint64_t(0)};
+    vector<unsigned char> b;
+    for (int i = 0; i != 9; ++i)
+        varint_put(x[i], b);
+    ASSERT_EQ(1 + 1 + 1 + 2 + 2 + 2 + 3 + 6 + 10, b.size());
+    const unsigned char* p = b.data();
+    for (int i = 0; i != 9; ++i)
+        ASSERT_EQ(x[i], varint_get(p));
+    ASSERT_EQ(b.data() + b.size(), p);
+    ASSERT_EQ(-5, unzigzag(zigzag(-5)));
+    ASSERT_EQ(3, zigzag(-2));
+}
+
+TEST(TestEncodedGraph, Skip_Blocks_1) {
+    // row 3 has ten blocks of targets; the lookups land before, on and between block starts
+    Graph g;
+    for (int i = 0; i < 1000; i += 3)
+        add_edge(3, i, g);
+    add_edge(999, 0, g);
+    const EncodedGraph e = encode(g);
+    ASSERT_EQ(334, out_degree(3, e));
+    for (int i = 0; i != 1000; ++i)
+        ASSERT_EQ(i % 3 == 0, edge(3, i, e).second);
+    ASSERT_TRUE(edge(999, 0, e).second);
+    pair<EncodedGraph::adjacency_iterator, EncodedGraph::adjacency_iterator> p = adjacent_vertices(3, e);
+    ASSERT_EQ(334, distance(p.first, p.second));
+}
+
+TEST(TestEncodedGraph, Multiset_1) {
+    basic_graph<int, directedS, multisetS> g;
+    for (int i = 0; i != 200; ++i)
+        add_edge(0, i / 3, g);
+    add_edge(1, 0, g);
+    const EncodedGraph e = encode(freeze(g));
+    ASSERT_EQ(201, num_edges(e));
+    ASSERT_TRUE(edge(0, 66, e).second);
+    ASSERT_FALSE(edge(0, 67, e).second);
+    pair<EncodedGraph::adjacency_iterator, EncodedGraph::adjacency_iterator> p = adjacent_vertices(0, e);
+    ASSERT_TRUE(equal(p.first, p.second, adjacent_vertices(0, g).first));
+}
+
+TEST(TestEncodedGraph, Rmat_1) {
+    const CompressedGraph c = freeze(rmat_graph<Graph>(12, 16 << 12, 5));
+    for (unsigned threads = 1; threads <= 4; threads *= 2) {
+        const EncodedGraph e = encode(c, threads);
+        ASSERT_EQ(num_vertices(c), num_vertices(e));
+        ASSERT_EQ(num_edges(c), num_edges(e));
+        pair<CompressedGraph::edge_iterator, CompressedGraph::edge_iterator> p = edges(c);
+        pair<EncodedGraph::edge_iterator, EncodedGraph::edge_iterator> q = edges(e);
+        for (; p.first != p.second; ++p.first, ++q.first)
+            ASSERT_EQ(*p.first, *q.first);
+        ASSERT_TRUE(q.first == q.second);
+        for (int a = 0; a < (int)num_vertices(c); a += 7)
+            for (int b = 0; b < (int)num_vertices(c); b += 13)
+                ASSERT_EQ(edge(a, b, c).second, edge(a, b, e).second);
+        const CompressedGraph d = freeze(e);
+        ASSERT_EQ(num_edges(c), num_edges(d));
+        ASSERT_TRUE(equal(edges(c).first, edges(c).second, edges(d).first));}
+}
+
+TEST(TestEncodedGraph, Stats_1) {
+    const CompressedGraph c = freeze(grid_graph<Graph>(100, 100));
+    const EncodedGraph    e = encode(c);
+    const graph_statistics s = graph_stats(c);
+    const graph_statistics t = graph_stats(e);
+    ASSERT_EQ(s.edges, t.edges);
+    ASSERT_EQ(s.degree_max, t.degree_max);
+    ASSERT_GT(s.total_bytes, 2 * t.total_bytes);
+}
+
+// -----------------
+// TestGraphTriangle
+// -----------------
+
+// the triangles of the simple undirected graph under g, by checking every triple
+std::size_t brute_triangles (const CompressedGraph& g, vector<std::size_t>& at) {
+    const int n = num_vertices(g);
+    vector< vector<char> > a(n, vector<char>(n, 0));
+    for (int u = 0; u != n; ++u) {
+        pair<const int*, const int*> p = adjacent_vertices(u, g);
+        for (; p.first != p.second; ++p.first)
+            if (*p.first != u)
+                a[u][*p.first] = a[*p.first][u] = 1;}
+    at.assign(n, 0);
+    std::size_t c = 0;
+    for (int u = 0; u != n; ++u)
+        for (int v = u + 1; v != n; ++v)
+            for (int w = v + 1; w != n; ++w)
+                if (a[u][v] && a[v][w] && a[u][w]) {
+                    ++c;
+                    ++at[u];
+                    ++at[v];
+                    ++at[w];}
+    return c;}
+
+TEST(TestGraphTriangle, Dynamic_For_1) {
+    vector<int> hits(1000, 0);
+    std::atomic<int> calls(0);
+    dynamic_for(1000, 4, 7, [&] (std::size_t b, std::size_t e, unsigned t) {
+        ASSERT_GT(4u, t);
+        ++calls;
+        for (; b != e; ++b)
+            ++hits[b];});
+    ASSERT_EQ(143, calls);
+    ASSERT_EQ(1000, count(hits.begin(), hits.end(), 1));
+}
+
+TEST(TestGraphTriangle, Intersect_Count_1) {
+    vector<int> a;
+    vector<int> b;
+    for (int i = 0; i != 3000; ++i)
+        b.push_back(2 * i);
+    a.push_back(-1);
+    a.push_back(0);
+    a.push_back(7);
+    a.push_back(5998);
+    a.push_back(6000);
+    ASSERT_EQ(2, intersect_count(a.data(), a.data() + a.size(), b.data(), b.data() + b.size()));
+    ASSERT_EQ(2, intersect_count(b.data(), b.data() + b.size(), a.data(), a.data() + a.size()));
+    ASSERT_EQ(3000, intersect_count(b.data(), b.data() + b.size(), b.data(), b.data() + b.size()));
+    ASSERT_EQ(0, intersect_count(a.data(), a.data(), b.data(), b.data() + b.size()));
+}
+
+TEST(TestGraphTriangle, Count_Triangles_1) {
+    // K4 with one edge in each direction, a self loop and a parallel edge
+    basic_graph<int, directedS, multisetS> g;
+    for (int u = 0; u != 4; ++u)
+        for (int v = 0; v != u; ++v)
+            add_edge(u % 2 ? u : v, u % 2 ? v : u, g);
+    add_edge(2, 2, g);
+    add_edge(0, 1, g);
+    add_vertex(g);
+    ASSERT_EQ(4, count_triangles(g));
+
+    vector<double> c;
+    ASSERT_DOUBLE_EQ(0.8, clustering_coefficient(g, c));
+    ASSERT_DOUBLE_EQ(1.0, c[2]);
+    ASSERT_DOUBLE_EQ(0.0, c[4]);
+}
+
+TEST(TestGraphTriangle, Count_Triangles_2) {
+    const CompressedGraph g = freeze(rmat_graph<Graph>(7, 8 << 7, 11));
+    vector<std::size_t> at;
+    const std::size_t expected = brute_triangles(g, at);
+    ASSERT_LT(0, expected);
+    for (unsigned threads = 1; threads <= 4; ++threads) {
+        ASSERT_EQ(expected, count_triangles(g, threads));
+        vector<std::size_t> t;
+        local_triangles(g, t, 0, threads);
+        ASSERT_TRUE(t == at);}
+}
+
+TEST(TestGraphTriangle, Common_Neighbors_1) {
+    Graph g;
+    add_edge(0, 2, g);
+    add_edge(0, 3, g);
+    add_edge(0, 5, g);
+    add_edge(1, 3, g);
+    add_edge(1, 5, g);
+    add_edge(1, 6, g);
+    vector<int> v;
+    common_neighbors(0, 1, g, back_inserter(v));
+    ASSERT_EQ(2, v.size());
+    ASSERT_EQ(3, v[0]);
+    ASSERT_EQ(5, v[1]);
+    ASSERT_EQ(2, count_common_neighbors(0, 1, g));
+    const CompressedGraph c = freeze(g);
+    ASSERT_EQ(2, count_common_neighbors(0, 1, c));
+    ASSERT_EQ(0, count_common_neighbors(0, 2, c));
+}
+
+// -------------------
+// TestGraphComponents
+// -------------------
+
+TEST(TestGraphComponents, Connected_Components_1) {
+    // one-way edges only: the components must still join across them
+    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> undirected_graph;
+    Graph g = rmat_graph<Graph>(11, 1 << 11, 13);
+    undirected_graph h(num_vertices(g));
+    Graph::edge_iterator b = edges(g).first;
+    Graph::edge_iterator e = edges(g).second;
+    for (; b != e; ++b)
+        add_edge(source(*b, g), target(*b, g), h);
+    vector<int> expected(num_vertices(g));
+    const int k = boost::connected_components(h, &expected[0]);
+    ASSERT_LT(1, k);
+    const CompressedGraph c = freeze(g);
+    for (unsigned threads = 1; threads <= 4; ++threads) {
+        vector<int> v(num_vertices(g));
+        ASSERT_EQ(k, connected_components(c, v.begin(), threads));
+        ASSERT_TRUE(v == expected);}
+}
+
+TEST(TestGraphComponents, Connected_Components_2) {
+    Graph g;
+    for (int i = 0; i != 5000; ++i)
+        add_edge(i + 1, i, g);
+    add_vertex(g);
+    vector<int> v(num_vertices(g));
+    ASSERT_EQ(2, connected_components(g, v.begin(), 3));
+    ASSERT_EQ(0, v[4999]);
+    ASSERT_EQ(1, v[5001]);
+}
+
+TEST(TestGraphComponents, Strong_Components_1) {
+    typedef boost::adjacency_list<boost::setS, boost::vecS, boost::directedS> boost_graph;
+    Graph g = rmat_graph<Graph>(10, 3 << 10, 17);
+    boost_graph h(num_vertices(g));
+    Graph::edge_iterator b = edges(g).first;
+    Graph::edge_iterator e = edges(g).second;
+    for (; b != e; ++b)
+        add_edge(source(*b, g), target(*b, g), h);
+    vector<int> expected(num_vertices(g));
+    const int k = boost::strong_components(h, &expected[0]);
+    vector<int> v(num_vertices(g));
+    ASSERT_EQ(k, strong_components(freeze(g), v.begin()));
+    ASSERT_TRUE(v == expected);
+}
+
+TEST(TestGraphComponents, Strong_Components_2) {
+    // a cycle too deep for a recursive search
+    Graph g;
+    for (int i = 0; i != 200000; ++i)
+        add_edge(i, (i + 1) % 200000, g);
+    add_edge(0, 200000, g);
+    vector<int> v(num_vertices(g));
+    ASSERT_EQ(2, strong_components(g, v.begin()));
+    ASSERT_EQ(0, v[200000]);
+    ASSERT_EQ(1, v[0]);
+    ASSERT_EQ(1, v[199999]);
+}
@@ -0,0 +1,67 @@
+// -----------------------------------
+// projects/graph/TestGraphMetrics.c++
+// -----------------------------------
+
+/*
+Tests the GraphMetrics.h hooks. They are compiled in only under GRAPH_INSTRUMENT, so
+these tests live in their own program and TestGraph.c++ stays an uninstrumented build;
+linking the two into one binary would give the inline Graph functions two definitions.
+
+To compile the test:
+    % g++ -pedantic -std=c++11 -Wall TestGraphMetrics.c++ -o TestGraphMetrics -lgtest -lgtest_main -lpthread
+
+To run the test:
+    % valgrind TestGraphMetrics
+*/
+
+// --------
+// includes
+// --------
+
+#include <vector> // vector
+
+#include "gtest/gtest.h"
+
+#define GRAPH_INSTRUMENT
+#include "Graph.h"
+
+using namespace std;
+
+// ----------------
+// TestGraphMetrics
+// ----------------
+
+// a sink that an exporter would attach
+struct TestSink : graph_metrics_sink {
+    vector<graph_op> ops;
+
+    void record (graph_op op, uint64_t) {
+        ops.push_back(op);}};
+
+TEST(TestGraphMetrics, Metrics_1) {
+    graph_counters& c = graph_default_counters();
+    c.reset();
+    Graph g;
+    add_edge(0, 1, g);
+    add_edge(0, 1, g);
+    edge(0, 1, g);
+    adjacent_vertices(0, g);
+    edges(g);
+    ASSERT_EQ(2, c.calls[op_add_edge]);
+    ASSERT_EQ(1, c.calls[op_add_edge_grow]);
+    ASSERT_EQ(1, c.calls[op_edge]);
+    ASSERT_EQ(1, c.calls[op_adjacent_vertices]);
+    ASSERT_EQ(1, c.calls[op_edges]);
+    ASSERT_EQ(0, c.nanoseconds[op_adjacent_vertices]);
+    ASSERT_EQ(0, c.nanoseconds[op_edges]);
+    ASSERT_STREQ("add_edge_grow", graph_op_name(op_add_edge_grow));
+
+    TestSink t;
+    ASSERT_EQ(&c, set_graph_metrics_sink(&t));
+    add_edge(3, 1, g);
+    ASSERT_EQ(&t, set_graph_metrics_sink(&c));
+    ASSERT_EQ(2, t.ops.size());
+    ASSERT_EQ(op_add_edge_grow, t.ops[0]);
+    ASSERT_EQ(op_add_edge, t.ops[1]);
+    ASSERT_EQ(2, c.calls[op_add_edge]);
+}
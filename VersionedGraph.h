@@ -0,0 +1,663 @@
+// -------------------------------
+// projects/graph/VersionedGraph.h
+// -------------------------------
+
+#ifndef VersionedGraph_h
+#define VersionedGraph_h
+
+// --------
+// includes
+// --------
+
+#include <atomic> // atomic_thread_fence
+#include <limits> // numeric_limits
+#include <memory> // atomic_load, atomic_store, shared_ptr
+#include <mutex>  // lock_guard, mutex
+
+#include "Graph.h"
+
+// The rows of a versioned graph live in the leaves of a radix tree with fanout 64.
+// Every node and row records the version that created it. Each write ends by publishing
+// its tree as the committed snapshot, and snapshot() copies that without the writer lock.
+// A write that finds a snapshot still sharing the root bumps the version, which makes the
+// whole tree read-only: a writer copies a node or row whose version is older than its own
+// before changing it, so only the path to a modified row is copied, once per snapshot.
+// Snapshots never see a write. A version is freed when the last snapshot holding it goes.
+
+template <typename VertexId, typename Directedness>
+class basic_versioned_graph;
+
+// --------------------
+// basic_graph_snapshot
+// --------------------
+
+/**
+ * immutable, consistent view of a basic_versioned_graph at one point in time; copies are
+ * cheap and share the tree, and any number of threads may read one without locking.
+ * As with basic_compressed_graph, a snapshot of an undirected graph holds both directions
+ * of every edge, so it reads as the symmetric directed graph.
+ */
+template <typename VertexId = int>
+class basic_graph_snapshot {
+    template <typename V, typename D>
+    friend class basic_versioned_graph;
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef VertexId vertex_descriptor;
+        typedef pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
+
+        typedef std::size_t vertices_size_type;
+        typedef std::size_t edges_size_type;
+
+        typedef const vertex_descriptor* adjacency_iterator;
+
+        typedef typename basic_compressed_graph<VertexId>::vertex_iterator vertex_iterator;
+
+    private:
+        // ----
+        // tree
+        // ----
+
+        static const unsigned           bits   = 6;
+        static const vertices_size_type fanout = vertices_size_type(1) << bits;
+
+        /**
+         * the sorted targets of one vertex
+         */
+        struct row {
+            unsigned long             version;
+            vector<vertex_descriptor> targets;};
+
+        /**
+         * an inner node uses child, a leaf uses rows; a null pointer is an empty subtree or row
+         */
+        struct node {
+            unsigned long            version;
+            vector< shared_ptr<node> > child;
+            vector< shared_ptr<row> >  rows;};
+
+        shared_ptr<const node> _root;
+        unsigned               _depth; // inner levels above the leaves
+        vertices_size_type     _n;
+        edges_size_type        _m;
+
+        /**
+         * @return returns the leaf that holds v, or 0 if that subtree is empty
+         */
+        const node* leaf (vertices_size_type v) const {
+            const node* p = _root.get();
+            for (unsigned l = _depth; p != 0 && l != 0; --l)
+                p = p->child[(v >> (bits * l)) & (fanout - 1)].get();
+            return p;}
+
+        /**
+         * @return returns the targets of v within leaf p, or 0 if the row is empty
+         */
+        static const vector<vertex_descriptor>* targets (const node* p, vertices_size_type v) {
+            const row* r = (p == 0) ? 0 : p->rows[v & (fanout - 1)].get();
+            return (r == 0 || r->targets.empty()) ? 0 : &r->targets;}
+
+        /**
+         * @param v a vertex below _n
+         * @return returns a pair of pointers over the row of v
+         */
+        std::pair<adjacency_iterator, adjacency_iterator> row_of (vertices_size_type v) const {
+            const vector<vertex_descriptor>* t = targets(leaf(v), v);
+            if (t == 0)
+                return std::make_pair(adjacency_iterator(0), adjacency_iterator(0));
+            return std::make_pair(t->data(), t->data() + t->size());}
+
+        basic_graph_snapshot (const shared_ptr<const node>& root, unsigned depth, vertices_size_type n, edges_size_type m) :
+                _root(root),
+                _depth(depth),
+                _n(n),
+                _m(m)
+            {}
+
+    public:
+        // ------------
+        // edge_iterator class
+        // ------------
+        class edge_iterator : public iterator<forward_iterator_tag, edge_descriptor>
+        {
+            public:
+                /**
+                 * Checks if two edge_iterators are equal.
+                 * @param rhs first edge_iterator
+                 * @param lhs second edge_iterator
+                 * @return true if equal, false if not
+                 */
+                friend bool operator == (const edge_iterator& rhs, const edge_iterator& lhs) {
+                    return (rhs._g == lhs._g) && (rhs._u == lhs._u) && (rhs._p == lhs._p);
+                }
+            private:
+                /**
+                 * moves to the next non-empty row while the current one is used up; the leaf is
+                 * looked up again only when a row crosses into the next leaf
+                 */
+                void settle() {
+                    while (_p == _e && _u != _g->_n) {
+                        if (++_u == _g->_n) {
+                            _p = _e = 0;
+                            break;}
+                        if ((_u & (fanout - 1)) == 0)
+                            _leaf = _g->leaf(_u);
+                        load();
+                    }
+                }
+
+                /**
+                 * points _p and _e at the row of _u within _leaf
+                 */
+                void load() {
+                    const vector<vertex_descriptor>* t = targets(_leaf, _u);
+                    _p = (t == 0) ? 0 : t->data();
+                    _e = (t == 0) ? 0 : t->data() + t->size();
+                }
+
+                const basic_graph_snapshot* _g;
+                vertices_size_type _u;
+                const node* _leaf;
+                adjacency_iterator _p;
+                adjacency_iterator _e;
+            public:
+                /**
+                 * Constructor for edge_iterator
+                 * @param g pointer to the snapshot being iterated on.
+                 * @param u the first row to visit; num_vertices for the end.
+                 */
+                edge_iterator(const basic_graph_snapshot* g, vertices_size_type u) :
+                    _g(g),
+                    _u(u),
+                    _leaf(),
+                    _p(),
+                    _e() {
+                    if (_u != _g->_n) {
+                        _leaf = _g->leaf(_u);
+                        load();
+                        settle();}
+                    }
+                /**
+                 * Dereferences edge_iterator
+                 * @return the edge_descriptor at the current position
+                 */
+                edge_descriptor operator * () const {
+                    return edge_descriptor(_u, *_p);
+                }
+                /**
+                 * Pre-increment on edge iterator.
+                 * @return reference to self (*this)
+                 */
+                edge_iterator& operator ++ () {
+                    ++_p;
+                    settle();
+                    return *this;
+                }
+                /**
+                 * Post-increment on edge iterator.
+                 * @return copy of this iterator before increment
+                 */
+                edge_iterator operator ++ (int) {
+                    edge_iterator temp = *this;
+                    ++*this;
+                    return temp;
+                }
+        };
+
+        // -----------------
+        // adjacent_vertices
+        // -----------------
+
+        /**
+         * @param v vertex_descriptor for which you want the adjacent vertices of
+         * @param g the snapshot for which to get the adjacent vertices from
+         * @return returns a pair of adjacency iterators over the contiguous row of v
+         */
+        friend std::pair<adjacency_iterator, adjacency_iterator> adjacent_vertices (vertex_descriptor v, const basic_graph_snapshot& g) {
+            return g.row_of(v);}
+
+        // ----
+        // edge
+        // ----
+
+        /**
+         * @param a vertex_descriptor of the main vertex
+         * @param b vertex_descriptor of the secondary vertex
+         * @param g snapshot for which to get the edge from
+         * @return returns a pair of an edge_descriptor and a boolean
+         */
+        friend std::pair<edge_descriptor, bool> edge (vertex_descriptor a, vertex_descriptor b, const basic_graph_snapshot& g) {
+            edge_descriptor e(a, b);
+            if ((vertices_size_type)a >= num_vertices(g) || (vertices_size_type)b >= num_vertices(g))
+                return make_pair(e, false);
+            std::pair<adjacency_iterator, adjacency_iterator> p = g.row_of(a);
+            return make_pair(e, binary_search(p.first, p.second, b));}
+
+        // -----
+        // edges
+        // -----
+
+        /**
+         * @param g the snapshot for which to get the iterator over edges from
+         * @return returns a pair of edge_iterators for the beginning and the end
+         */
+        friend std::pair<edge_iterator, edge_iterator> edges (const basic_graph_snapshot& g) {
+            return std::make_pair(edge_iterator(&g, 0), edge_iterator(&g, g._n));}
+
+        // ----------
+        // out_degree
+        // ----------
+
+        /**
+         * @param v vertex_descriptor of the source vertex
+         * @param g the snapshot
+         * @return returns the number of edges out of v
+         */
+        friend edges_size_type out_degree (vertex_descriptor v, const basic_graph_snapshot& g) {
+            std::pair<adjacency_iterator, adjacency_iterator> p = g.row_of(v);
+            return p.second - p.first;}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param g the snapshot for which to get the number of edges from
+         * @return returns the number of edges in the snapshot
+         */
+        friend edges_size_type num_edges (const basic_graph_snapshot& g) {
+            return g._m;}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g the snapshot for which to get the number of vertices from
+         * @return returns the number of vertices in the snapshot
+         */
+        friend vertices_size_type num_vertices (const basic_graph_snapshot& g) {
+            return g._n;}
+
+        // ------
+        // source
+        // ------
+
+        /**
+         * @param e edge_descriptor from which to get the source
+         * @param g the snapshot for which to get the source from
+         * @return returns the main vertex in an edge
+         */
+        friend vertex_descriptor source (edge_descriptor e, const basic_graph_snapshot&) {
+            return e.first;}
+
+        // ------
+        // target
+        // ------
+
+        /**
+         * @param e edge_descriptor from which to get the target
+         * @param g the snapshot for which to get the target from
+         * @return returns the secondary vertex in an edge
+         */
+        friend vertex_descriptor target (edge_descriptor e, const basic_graph_snapshot&) {
+            return e.second;}
+
+        // ------
+        // vertex
+        // ------
+
+        /**
+         * @param i index of the vertex
+         * @param g snapshot from which to get the vertex_descriptor from
+         * @return returns the vertex_descriptor at index i
+         */
+        friend vertex_descriptor vertex (vertices_size_type i, const basic_graph_snapshot&) {
+            return i;}
+
+        // --------
+        // vertices
+        // --------
+
+        /**
+         * @param g snapshot from which to get the vertex iterators from
+         * @return returns a pair of vertex iterators which are the beginning and the end of the snapshot's vertices
+         */
+        friend std::pair<vertex_iterator, vertex_iterator> vertices (const basic_graph_snapshot& g) {
+            return make_pair(vertex_iterator(0), vertex_iterator(num_vertices(g)));}
+
+        // ------
+        // freeze
+        // ------
+
+        /**
+         * @param g the snapshot to pack
+         * @return returns a basic_compressed_graph with the same vertices and edges as g
+         */
+        friend basic_compressed_graph<vertex_descriptor> freeze (const basic_graph_snapshot& g) {
+            struct arrays {
+                vector<edges_size_type>   offsets;
+                vector<vertex_descriptor> targets;};
+            shared_ptr<arrays> a = make_shared<arrays>();
+            a->offsets.reserve(g._n + 1);
+            a->targets.reserve(g._m);
+            a->offsets.push_back(0);
+            for (vertices_size_type v = 0; v != g._n; ++v) {
+                std::pair<adjacency_iterator, adjacency_iterator> p = g.row_of(v);
+                a->targets.insert(a->targets.end(), p.first, p.second);
+                a->offsets.push_back(a->targets.size());}
+            return basic_compressed_graph<vertex_descriptor>(a, a->offsets.data(), a->targets.data(), g._n);}
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * builds an empty snapshot
+         */
+        basic_graph_snapshot () :
+                _root(),
+                _depth(0),
+                _n(0),
+                _m(0)
+            {}
+
+        // Default copy, destructor, and copy assignment
+    };
+
+/**
+ * the snapshot type of VersionedGraph
+ */
+typedef basic_graph_snapshot<> GraphSnapshot;
+
+// ---------------------
+// basic_versioned_graph
+// ---------------------
+
+/**
+ * Mutable graph with copy-on-write versions. Writers are serialized by one mutex;
+ * snapshot() is O(1), does not wait for add_edges, and the snapshot it returns never changes.
+ * @param VertexId the integral type of a vertex_descriptor
+ * @param Directedness directedS or undirectedS
+ */
+template <typename VertexId = int, typename Directedness = directedS>
+class basic_versioned_graph {
+    static_assert(!Directedness::has_in_edges, "basic_versioned_graph supports directedS and undirectedS");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef VertexId vertex_descriptor;
+        typedef pair<vertex_descriptor, vertex_descriptor> edge_descriptor;
+
+        typedef Directedness directed_category;
+
+        typedef std::size_t vertices_size_type;
+        typedef std::size_t edges_size_type;
+
+        typedef basic_graph_snapshot<VertexId> snapshot_type;
+
+        typedef flat_setS::row<vertex_descriptor> row_policy;
+
+    private:
+        typedef typename snapshot_type::node node;
+        typedef typename snapshot_type::row  row;
+
+        static const unsigned           bits   = snapshot_type::bits;
+        static const vertices_size_type fanout = snapshot_type::fanout;
+
+        // ----
+        // data
+        // ----
+
+        shared_ptr<node>   _root;
+        unsigned           _depth;
+        vertices_size_type _n;
+        edges_size_type    _m;
+        edges_size_type    _targets; // _m, plus the reverse of every undirected non-loop edge
+        unsigned long      _version; // nodes and rows of this version belong to the writer alone
+        mutable mutex      _lock;
+
+        shared_ptr<const snapshot_type> _published; // the last write; only touched with atomic_load and atomic_store
+
+        // ---
+        // own
+        // ---
+
+        /**
+         * makes p a node of the current version, copying it if a snapshot may hold it
+         * @param p a child slot or the root
+         * @param inner true for an inner node, false for a leaf
+         * @return returns the node, which may now be written
+         */
+        node* own (shared_ptr<node>& p, bool inner) {
+            if (!p) {
+                p = make_shared<node>();
+                if (inner)
+                    p->child.resize(fanout);
+                else
+                    p->rows.resize(fanout);}
+            else if (p->version != _version)
+                p = make_shared<node>(*p);
+            p->version = _version;
+            return p.get();}
+
+        /**
+         * @param v a vertex below _n
+         * @return returns the targets of v, copied first if a snapshot may hold them
+         */
+        vector<vertex_descriptor>& writable (vertices_size_type v) {
+            node* p = own(_root, _depth != 0);
+            for (unsigned l = _depth; l != 0; --l)
+                p = own(p->child[(v >> (bits * l)) & (fanout - 1)], l != 1);
+            shared_ptr<row>& r = p->rows[v & (fanout - 1)];
+            if (!r)
+                r = make_shared<row>();
+            else if (r->version != _version)
+                r = make_shared<row>(*r);
+            r->version = _version;
+            return r->targets;}
+
+        /**
+         * adds levels above the root until the tree can hold z vertices; the tree stops
+         * growing once a level would cover every vertices_size_type, so 64-bit ids cannot
+         * shift the capacity past the width of the type
+         */
+        void grow (vertices_size_type z) {
+            const unsigned width = std::numeric_limits<vertices_size_type>::digits;
+            while (bits * (_depth + 1) < width && ((z - 1) >> (bits * (_depth + 1))) != 0) {
+                if (_root) {
+                    shared_ptr<node> p = make_shared<node>();
+                    p->version = _version;
+                    p->child.resize(fanout);
+                    p->child[0] = _root;
+                    _root = p;}
+                ++_depth;}
+            _n = max(_n, z);}
+
+        /**
+         * starts a write; the caller holds _lock
+         * @param retract true to withdraw the published snapshot until publish, so that a short
+         *        write can keep changing the tree in place; a long write leaves it up and freezes
+         *        the tree instead, so that snapshot never waits for it
+         */
+        void begin_write (bool retract) {
+            if (retract)
+                std::atomic_store(&_published, shared_ptr<const snapshot_type>());
+            // no new reference to the root can appear now, so a count of one is final
+            if (_root.use_count() > 1)
+                ++_version;
+            // pairs with the release of the last snapshot that held the root
+            std::atomic_thread_fence(std::memory_order_acquire);}
+
+        /**
+         * @return returns a snapshot sharing the current tree; the caller holds _lock
+         */
+        snapshot_type current () const {
+            return snapshot_type(_root, _depth, _n, _targets);}
+
+        /**
+         * ends a write by making its tree the one snapshot returns; the caller holds _lock
+         */
+        void publish () {
+            std::atomic_store(&_published, shared_ptr<const snapshot_type>(new snapshot_type(current())));}
+
+    public:
+        // --------
+        // add_edge
+        // --------
+
+        /**
+         * @param a vertex_descriptor to the first vertex
+         * @param b vertex_descriptor to the second vertex
+         * @param g the graph for which to add the edge
+         * @return returns a pair of an edge_descriptor and a boolean for successful or not
+         */
+        friend std::pair<edge_descriptor, bool> add_edge (vertex_descriptor a, vertex_descriptor b, basic_versioned_graph& g) {
+            lock_guard<mutex> l(g._lock);
+            g.begin_write(true);
+            edge_descriptor e(a, b);
+            g.grow((vertices_size_type)max(a, b) + 1);
+            const bool added = row_policy::insert(g.writable(a), b);
+            if (added) {
+                if (!Directedness::is_directed && a != b)
+                    g._targets += row_policy::insert(g.writable(b), a);
+                ++g._m;
+                ++g._targets;}
+            g.publish();
+            return make_pair(e, added);}
+
+        // ----------
+        // add_vertex
+        // ----------
+
+        /**
+         * @param g graph for which to add the vertex
+         * @return returns the vertex_descriptor for the new vertex
+         */
+        friend vertex_descriptor add_vertex (basic_versioned_graph& g) {
+            lock_guard<mutex> l(g._lock);
+            g.begin_write(true);
+            g.grow(g._n + 1);
+            g.publish();
+            return g._n - 1;}
+
+        // ---------
+        // add_edges
+        // ---------
+
+        /**
+         * Inserts a range of edges as one write: the edges are sorted by source and each
+         * touched row is copied at most once and merged with its new targets.
+         * @param first iterator to the first edge_descriptor to add
+         * @param last iterator past the last edge_descriptor to add
+         * @param g the graph for which to add the edges
+         * @return returns the number of edges that were not already in g
+         */
+        template <typename FI>
+        friend edges_size_type add_edges (FI first, FI last, basic_versioned_graph& g) {
+            vector<edge_descriptor> v(first, last);
+            if (!Directedness::is_directed)
+                for (std::size_t i = 0, k = v.size(); i != k; ++i)
+                    if (v[i].first != v[i].second)
+                        v.push_back(edge_descriptor(v[i].second, v[i].first));
+            sort(v.begin(), v.end());
+            vector<vertex_descriptor> t;
+            edges_size_type added = 0;
+            edges_size_type loops = 0;
+            lock_guard<mutex> l(g._lock);
+            g.begin_write(false);
+            for (typename vector<edge_descriptor>::const_iterator b = v.begin(); b != v.end(); ) {
+                typename vector<edge_descriptor>::const_iterator e = b;
+                t.clear();
+                for (; e != v.end() && e->first == b->first; ++e) {
+                    t.push_back(e->second);
+                    g.grow((vertices_size_type)max(e->first, e->second) + 1);}
+                vector<vertex_descriptor>& r = g.writable(b->first);
+                const bool loop = binary_search(r.begin(), r.end(), b->first);
+                added += row_policy::merge(r, t.begin(), t.end());
+                loops += !loop && binary_search(r.begin(), r.end(), b->first);
+                b = e;}
+            // an undirected edge adds two targets, a self loop one
+            const edges_size_type m = Directedness::is_directed ? added : (added - loops) / 2 + loops;
+            g._m += m;
+            g._targets += added;
+            g.publish();
+            return m;}
+
+        // --------
+        // snapshot
+        // --------
+
+        /**
+         * O(1): shares the tree of the last finished write, which the next write freezes.
+         * Only a single edge or vertex write in progress is waited for; add_edges is not.
+         * @param g the graph
+         * @return returns an immutable view of g as of the last finished write
+         */
+        friend snapshot_type snapshot (basic_versioned_graph& g) {
+            const shared_ptr<const snapshot_type> p = std::atomic_load(&g._published);
+            if (p)
+                return *p;
+            lock_guard<mutex> l(g._lock);
+            return g.current();}
+
+        // ---------
+        // num_edges
+        // ---------
+
+        /**
+         * @param g the graph for which to get the number of edges from
+         * @return returns the number of edges in the graph
+         */
+        friend edges_size_type num_edges (const basic_versioned_graph& g) {
+            lock_guard<mutex> l(g._lock);
+            return g._m;}
+
+        // ------------
+        // num_vertices
+        // ------------
+
+        /**
+         * @param g the graph for which to get the number of vertices from
+         * @return returns the number of vertices in the graph
+         */
+        friend vertices_size_type num_vertices (const basic_versioned_graph& g) {
+            lock_guard<mutex> l(g._lock);
+            return g._n;}
+
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * builds an empty graph
+         */
+        basic_versioned_graph () :
+                _root(),
+                _depth(0),
+                _n(0),
+                _m(0),
+                _targets(0),
+                _version(0),
+                _lock(),
+                _published(new snapshot_type())
+            {}
+
+        // the lock is not copyable; copy a snapshot instead
+        basic_versioned_graph (const basic_versioned_graph&) = delete;
+        basic_versioned_graph& operator = (const basic_versioned_graph&) = delete;
+    };
+
+/**
+ * the versioned counterpart of Graph
+ */
+typedef basic_versioned_graph<> VersionedGraph;
+
+#endif // VersionedGraph_h